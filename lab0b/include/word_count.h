@@ -0,0 +1,53 @@
+#pragma once
+
+#include "word_table.h"
+
+#include <iosfwd>
+
+/*!
+ * Word frequency counting for the lab0b counter.
+ *
+ * A word is a maximal run of characters for which `iswalnum` is true in the
+ * global locale; everything else separates words. Both counting functions
+ * decode the input with the global locale, which must be set before they
+ * are called.
+ */
+namespace word_count {
+
+/*!
+ * Count the words of a stream line by line, up to its end or the first
+ * character it fails to decode.
+ * @param in The stream to read to its end.
+ * @param words The table to add the count of each word to.
+ * Returns the number of words read.
+ */
+long count_stream(std::wistream &in, WordTable &words);
+
+/*!
+ * Count the words of a file by mapping it into memory and splitting it into
+ * chunks at separator bytes, each counted on its own thread into a table
+ * of its own; the tables are merged at the end. The result is the same as
+ * from `count_stream` over the same valid file.
+ *
+ * Counting stops at the first invalid or incomplete character, as in the
+ * stream reader, and the words before it are counted. The stream reader may
+ * also lose the words before it on the same line: that depends on whether
+ * the character falls in the last block its buffer reads.
+ * @param path The file to read.
+ * @param threads The number of threads, or 0 for one per hardware thread.
+ * At most one thread per hardware thread and per 64 KiB of input is used.
+ * @param words The table to add the count of each word to.
+ * Returns the number of words read. Throws std::runtime_error if the file
+ * cannot be read.
+ */
+long count_file(const char *path, unsigned threads, WordTable &words);
+
+/*!
+ * Write one CSV line `word,count,percent` per word, most frequent first.
+ * @param out The stream to write to.
+ * @param words The count of each word.
+ * @param word_count The total number of words, for the percentages.
+ */
+void write_csv(std::wostream &out, const WordTable &words, long word_count);
+
+} // namespace word_count
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*!
+ * Word counts in a flat open-addressing hash table.
+ *
+ * The characters of the keys are copied once, when a word is first seen,
+ * into an arena of large blocks, and the table itself is an array of slots
+ * probed linearly, so counting a word seen before allocates nothing and
+ * usually touches one slot.
+ */
+class WordTable {
+public:
+    WordTable() = default;
+    WordTable(WordTable &&) noexcept = default;
+    WordTable &operator=(WordTable &&) noexcept = default;
+
+    WordTable(const WordTable &) = delete;
+    WordTable &operator=(const WordTable &) = delete;
+
+    /*!
+     * Add `count` to the count of `word`.
+     * @param word The word; copied if new to the table.
+     * @param count The number to add.
+     */
+    void add(std::wstring_view word, long count = 1);
+
+    /*!
+     * Add the counts of another table to this one.
+     * @param other The table to add.
+     */
+    void merge(const WordTable &other);
+
+    /*!
+     * Returns the count of `word`, 0 if it has not been added.
+     */
+    long count(std::wstring_view word) const;
+
+    /*!
+     * Returns the number of distinct words.
+     */
+    size_t size() const { return num_words; }
+
+    /*!
+     * Returns the words and their counts, most frequent first and words
+     * with equal counts in reverse lexicographic order. The views point into
+     * the table and stay valid while it exists.
+     */
+    std::vector<std::pair<std::wstring_view, long>> sorted() const;
+
+private:
+    struct Slot {
+        // Null for an empty slot
+        const wchar_t *key = nullptr;
+        size_t length = 0;
+        uint64_t hash = 0;
+        long count = 0;
+    };
+
+    static uint64_t hash(std::wstring_view word);
+    // The slot of `word`, or the empty slot where it would go
+    size_t probe(std::wstring_view word, uint64_t h) const;
+    void add(std::wstring_view word, uint64_t h, long count);
+    void rehash(size_t new_capacity);
+    const wchar_t *intern(std::wstring_view word);
+
+    std::vector<Slot> slots;
+    size_t num_words = 0;
+
+    // Keys are never freed before the table, so the arena only grows
+    std::vector<std::unique_ptr<wchar_t[]>> blocks;
+    wchar_t *block_next = nullptr;
+    size_t block_left = 0;
+};
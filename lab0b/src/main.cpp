@@ -1,9 +1,11 @@
+#include "word_count.h"
+
 #include <fstream>
-#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <locale>
-#include <map>
-#include <set>
+#include <stdexcept>
+#include <string>
 
 int main(int argc, char *argv[]) {
     using namespace std;
@@ -16,15 +18,44 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    if (argc != 3) {
-        cout << "Usage: " << argv[0] << " input.txt output.csv" << endl;
+    if (argc != 3 && argc != 4) {
+        cout << "Usage: " << argv[0] << " input.txt output.csv [threads]"
+             << endl;
+        cout << "With threads, the input is mapped into memory and split "
+                "between that many threads, at most one per core (0 for one "
+                "per core)."
+             << endl;
         return EXIT_FAILURE;
     }
 
-    wifstream fin(argv[1]);
-    if (!fin) {
-        cout << "Cannot open input file: " << argv[1] << endl;
-        return EXIT_FAILURE;
+    unsigned threads = 0;
+    if (argc == 4) {
+        // stoul would accept a sign and wrap "-1" around to ULONG_MAX
+        string arg = argv[3];
+        unsigned long value = 0;
+        bool valid = !arg.empty() &&
+                     arg.find_first_not_of("0123456789") == string::npos;
+        if (valid) {
+            try {
+                value = stoul(arg);
+            } catch (out_of_range &e) {
+                valid = false;
+            }
+        }
+        if (!valid || value > numeric_limits<unsigned>::max()) {
+            cout << "Invalid number of threads: " << argv[3] << endl;
+            return EXIT_FAILURE;
+        }
+        threads = static_cast<unsigned>(value);
+    }
+
+    wifstream fin;
+    if (argc == 3) {
+        fin.open(argv[1]);
+        if (!fin) {
+            cout << "Cannot open input file: " << argv[1] << endl;
+            return EXIT_FAILURE;
+        }
     }
 
     wofstream fout(argv[2]);
@@ -34,34 +65,20 @@ int main(int argc, char *argv[]) {
     }
 
     long word_count = 0;
-    map<wstring, long> word_map;
+    WordTable words;
 
-    wstring line;
-    while (getline(fin, line)) {
-        wstring word;
-        for (auto it = line.begin(); it != line.end(); it++) {
-            if (iswalnum(*it)) {
-                word += *it;
-            } else if (!word.empty()) {
-                word_map[word]++;
-                word_count++;
-                word.clear();
-            }
-        }
-        if (!word.empty()) {
-            word_map[word]++;
-            word_count++;
+    if (argc == 4) {
+        try {
+            word_count = word_count::count_file(argv[1], threads, words);
+        } catch (runtime_error &e) {
+            cout << e.what() << endl;
+            return EXIT_FAILURE;
         }
+    } else {
+        word_count = word_count::count_stream(fin, words);
     }
 
-    set<pair<long, wstring>> temp;
-    for (auto it = word_map.begin(); it != word_map.end(); it++) {
-        temp.insert({it->second, it->first});
-    }
-    for (auto it = temp.rbegin(); it != temp.rend(); it++) {
-        fout << it->second << "," << it->first << "," << setprecision(3)
-             << static_cast<double>(it->first) * 100 / word_count << endl;
-    }
+    word_count::write_csv(fout, words, word_count);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,232 @@
+#include "word_count.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <cwctype>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORD_COUNT_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace word_count {
+namespace {
+
+// The smallest chunk worth a thread of its own
+constexpr size_t min_chunk_bytes = 64 * 1024;
+
+/*!
+ * The bytes of a file, mapped read-only where the system can map files and
+ * read into memory elsewhere.
+ */
+class FileBytes {
+public:
+    explicit FileBytes(const char *path) {
+#ifdef WORD_COUNT_MMAP
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("Cannot open input file: ") +
+                                     path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error(std::string("Cannot read input file: ") +
+                                     path);
+        }
+        bytes = static_cast<size_t>(st.st_size);
+        if (bytes != 0) {
+            void *p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error(
+                    std::string("Cannot map input file: ") + path);
+            }
+            // Every thread reads its chunk from start to end
+            madvise(p, bytes, MADV_SEQUENTIAL);
+            mapped = static_cast<const char *>(p);
+        }
+        close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error(std::string("Cannot open input file: ") +
+                                     path);
+        }
+        copy.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+        bytes = copy.size();
+#endif
+    }
+
+    FileBytes(const FileBytes &) = delete;
+    FileBytes &operator=(const FileBytes &) = delete;
+
+    ~FileBytes() {
+#ifdef WORD_COUNT_MMAP
+        if (mapped != nullptr) {
+            munmap(const_cast<char *>(mapped), bytes);
+        }
+#endif
+    }
+
+    const char *data() const {
+#ifdef WORD_COUNT_MMAP
+        return mapped;
+#else
+        return copy.data();
+#endif
+    }
+
+    size_t size() const { return bytes; }
+
+private:
+    size_t bytes = 0;
+#ifdef WORD_COUNT_MMAP
+    const char *mapped = nullptr;
+#else
+    std::string copy;
+#endif
+};
+
+// An ASCII byte is never part of a multibyte character in the encodings the
+// counter is meant for, so one that is not alphanumeric is a safe place to
+// split the input: it ends a character and a word.
+bool is_separator(char c) {
+    auto b = static_cast<unsigned char>(c);
+    return b < 0x80 && !iswalnum(b);
+}
+
+void add_word(std::wstring &word, WordTable &words, long &word_count) {
+    if (!word.empty()) {
+        words.add(word);
+        word_count++;
+        word.clear();
+    }
+}
+
+struct ChunkCount {
+    long words = 0;
+    // True if the chunk holds an invalid or cut off character
+    bool stopped = false;
+};
+
+/*!
+ * Count the words of a chunk up to its end or its first invalid character,
+ * where the stream reader of `count_stream` stops too.
+ */
+ChunkCount count_chunk(const char *first, const char *last, WordTable &words) {
+    ChunkCount res;
+    std::wstring word;
+    std::mbstate_t state{};
+    while (first != last) {
+        auto b = static_cast<unsigned char>(*first);
+        wchar_t c = b;
+        size_t n = 1;
+        if (b >= 0x80) {
+            n = std::mbrtowc(&c, first, last - first, &state);
+            if (n == static_cast<size_t>(-1) || n == static_cast<size_t>(-2)) {
+                res.stopped = true;
+                break;
+            }
+        }
+        if (iswalnum(c)) {
+            word += c;
+        } else {
+            add_word(word, words, res.words);
+        }
+        first += n;
+    }
+    add_word(word, words, res.words);
+    return res;
+}
+
+} // namespace
+
+long count_stream(std::wistream &in, WordTable &words) {
+    long word_count = 0;
+    std::wstring line;
+    while (getline(in, line)) {
+        std::wstring word;
+        for (auto it = line.begin(); it != line.end(); it++) {
+            if (iswalnum(*it)) {
+                word += *it;
+            } else {
+                add_word(word, words, word_count);
+            }
+        }
+        add_word(word, words, word_count);
+    }
+    return word_count;
+}
+
+long count_file(const char *path, unsigned threads, WordTable &words) {
+    FileBytes file(path);
+    const char *data = file.data();
+    size_t size = file.size();
+    // More threads than cores only add tables to merge, and a thread per
+    // few bytes of input would be all overhead.
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 0 || threads > cores) {
+        threads = cores;
+    }
+    threads = static_cast<unsigned>(
+        std::clamp<size_t>(size / min_chunk_bytes, 1, threads));
+
+    // Chunk i starts at the first separator at or after i / threads of the
+    // file, so no word is split between two chunks
+    std::vector<size_t> bounds{0};
+    for (unsigned i = 1; i < threads; i++) {
+        size_t pos = std::max(bounds.back(), size / threads * i);
+        while (pos < size && !is_separator(data[pos])) {
+            pos++;
+        }
+        bounds.push_back(pos);
+    }
+    bounds.push_back(size);
+
+    std::vector<WordTable> tables(threads);
+    std::vector<ChunkCount> counts(threads);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back([&, i] {
+            counts[i] = count_chunk(data + bounds[i], data + bounds[i + 1],
+                                    tables[i]);
+        });
+    }
+    counts[0] = count_chunk(data + bounds[0], data + bounds[1], tables[0]);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    long word_count = 0;
+    for (unsigned i = 0; i < threads; i++) {
+        words.merge(tables[i]);
+        word_count += counts[i].words;
+        if (counts[i].stopped) {
+            // Nothing after the first invalid character is counted
+            break;
+        }
+    }
+    return word_count;
+}
+
+void write_csv(std::wostream &out, const WordTable &words, long word_count) {
+    for (const auto &[word, count] : words.sorted()) {
+        out << word << "," << count << "," << std::setprecision(3)
+            << static_cast<double>(count) * 100 / word_count << '\n';
+    }
+}
+
+} // namespace word_count
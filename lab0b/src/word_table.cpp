@@ -0,0 +1,125 @@
+#include "word_table.h"
+
+#include <algorithm>
+#include <cwchar>
+
+namespace {
+
+constexpr size_t initial_capacity = 1024;
+
+// Characters per arena block; longer words get a block of their own
+constexpr size_t block_size = 64 * 1024;
+
+} // namespace
+
+void WordTable::add(std::wstring_view word, long count) {
+    add(word, hash(word), count);
+}
+
+void WordTable::merge(const WordTable &other) {
+    for (const Slot &slot : other.slots) {
+        if (slot.key != nullptr) {
+            add(std::wstring_view(slot.key, slot.length), slot.hash,
+                slot.count);
+        }
+    }
+}
+
+long WordTable::count(std::wstring_view word) const {
+    if (slots.empty()) {
+        return 0;
+    }
+    return slots[probe(word, hash(word))].count;
+}
+
+std::vector<std::pair<std::wstring_view, long>> WordTable::sorted() const {
+    std::vector<std::pair<std::wstring_view, long>> res;
+    res.reserve(num_words);
+    for (const Slot &slot : slots) {
+        if (slot.key != nullptr) {
+            res.emplace_back(std::wstring_view(slot.key, slot.length),
+                             slot.count);
+        }
+    }
+    std::sort(res.begin(), res.end(), [](const auto &a, const auto &b) {
+        if (a.second != b.second) {
+            return a.second > b.second;
+        }
+        return a.first > b.first;
+    });
+    return res;
+}
+
+uint64_t WordTable::hash(std::wstring_view word) {
+    uint64_t h = word.size();
+    for (wchar_t c : word) {
+        h = (h + static_cast<uint32_t>(c)) * 0x9E3779B97F4A7C15ull;
+    }
+    // The multiplications carry into the high bits only, and slots are
+    // picked by the low ones
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return h;
+}
+
+size_t WordTable::probe(std::wstring_view word, uint64_t h) const {
+    size_t mask = slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot &slot = slots[i];
+        if (slot.key == nullptr ||
+            (slot.hash == h && slot.length == word.size() &&
+             std::wmemcmp(slot.key, word.data(), word.size()) == 0)) {
+            return i;
+        }
+    }
+}
+
+void WordTable::add(std::wstring_view word, uint64_t h, long count) {
+    if (slots.empty()) {
+        rehash(initial_capacity);
+    }
+    size_t i = probe(word, h);
+    if (slots[i].key == nullptr) {
+        // At most half full, so that probe runs stay short
+        if (2 * (num_words + 1) > slots.size()) {
+            rehash(2 * slots.size());
+            i = probe(word, h);
+        }
+        slots[i] = Slot{intern(word), word.size(), h, 0};
+        num_words++;
+    }
+    slots[i].count += count;
+}
+
+void WordTable::rehash(size_t new_capacity) {
+    std::vector<Slot> old(new_capacity);
+    old.swap(slots);
+    size_t mask = new_capacity - 1;
+    for (const Slot &slot : old) {
+        if (slot.key == nullptr) {
+            continue;
+        }
+        size_t i = slot.hash & mask;
+        while (slots[i].key != nullptr) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
+
+const wchar_t *WordTable::intern(std::wstring_view word) {
+    // An empty word still needs a non-null key
+    size_t length = std::max<size_t>(word.size(), 1);
+    if (length > block_left) {
+        size_t size = std::max(length, block_size);
+        blocks.push_back(std::make_unique_for_overwrite<wchar_t[]>(size));
+        block_next = blocks.back().get();
+        block_left = size;
+    }
+    wchar_t *key = block_next;
+    std::copy(word.begin(), word.end(), key);
+    block_next += length;
+    block_left -= length;
+    return key;
+}
@@ -0,0 +1,118 @@
+#include "word_count.h"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Временный файл, удаляемый в конце теста
+class TempFile {
+public:
+    TempFile(const std::string &name, const std::string &bytes)
+        : path((std::filesystem::temp_directory_path() / name).string()) {
+        std::ofstream(path, std::ios::binary) << bytes;
+    }
+    ~TempFile() { std::filesystem::remove(path); }
+
+    std::string path;
+};
+
+// Текст в UTF-8 из русских и английских слов с разными разделителями
+std::string make_text(size_t num_words) {
+    const char *vocabulary[] = {"мир", "Мир", "слово", "word", "Word", "и",
+                                "a", "42", "ёлка", "x1", "данные", "test"};
+    const char *separators[] = {" ", ", ", ".\n", " - ", "\n", "!? ", "\t"};
+    std::string text;
+    uint64_t x = 88172645463325252ull;
+    for (size_t i = 0; i < num_words; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        text += vocabulary[x % std::size(vocabulary)];
+        text += separators[(x >> 32) % std::size(separators)];
+    }
+    return text;
+}
+
+std::wstring to_csv(const WordTable &words, long word_count) {
+    std::wostringstream out;
+    word_count::write_csv(out, words, word_count);
+    return out.str();
+}
+
+} // namespace
+
+// Тест подсчёта слов в потоке
+TEST(WordCountTest, CountStream) {
+    std::wistringstream in(L"Привет, мир! привет 42\n\nмир-мир x1");
+    WordTable words;
+    EXPECT_EQ(word_count::count_stream(in, words), 7);
+    EXPECT_EQ(words.size(), 5);
+    EXPECT_EQ(words.count(L"мир"), 3);
+    EXPECT_EQ(words.count(L"Привет"), 1);
+    EXPECT_EQ(words.count(L"привет"), 1);
+    EXPECT_EQ(words.count(L"x1"), 1);
+}
+
+// Тест формата CSV
+TEST(WordCountTest, WriteCsv) {
+    WordTable words;
+    words.add(L"b", 1);
+    words.add(L"a", 3);
+    words.add(L"c", 1);
+    EXPECT_EQ(to_csv(words, 5), L"a,3,60\nc,1,20\nb,1,20\n");
+}
+
+// Тест совпадения CSV при чтении файла потоком и по частям в потоках
+TEST(WordCountTest, FileMatchesStream) {
+    TempFile file("lab0b_word_count_test.txt", make_text(200000));
+
+    WordTable expected_words;
+    std::wifstream in(file.path);
+    long expected = word_count::count_stream(in, expected_words);
+    EXPECT_EQ(expected, 200000);
+    std::wstring expected_csv = to_csv(expected_words, expected);
+
+    for (unsigned threads : {0u, 1u, 2u, 7u}) {
+        WordTable words;
+        long count = word_count::count_file(file.path.c_str(), threads, words);
+        EXPECT_EQ(count, expected) << threads;
+        EXPECT_EQ(to_csv(words, count), expected_csv) << threads;
+    }
+}
+
+// Тест остановки на неверной последовательности UTF-8
+TEST(WordCountTest, StopsAtInvalidUtf8) {
+    TempFile file("lab0b_word_count_invalid.txt",
+                  "один два\nтри \xff четыре\nпять");
+    WordTable words;
+    EXPECT_EQ(word_count::count_file(file.path.c_str(), 0, words), 3);
+    EXPECT_EQ(words.count(L"три"), 1);
+    EXPECT_EQ(words.count(L"четыре"), 0);
+}
+
+// Тест пустого и отсутствующего файла
+TEST(WordCountTest, EmptyAndMissingFile) {
+    TempFile file("lab0b_word_count_empty.txt", "");
+    WordTable words;
+    EXPECT_EQ(word_count::count_file(file.path.c_str(), 0, words), 0);
+    EXPECT_EQ(words.size(), 0);
+    EXPECT_THROW(word_count::count_file("/nonexistent/lab0b.txt", 0, words),
+                 std::runtime_error);
+}
+
+int main(int argc, char **argv) {
+    // Слова разбираются в глобальной локали, как в самой программе
+    try {
+        std::locale::global(std::locale("ru_RU.UTF-8"));
+    } catch (std::runtime_error &) {
+        std::locale::global(std::locale("C.UTF-8"));
+    }
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+#include "word_table.h"
+#include <gtest/gtest.h>
+
+#include <string>
+
+// Тест добавления и подсчёта слов
+TEST(WordTableTest, AddAndCount) {
+    WordTable words;
+    EXPECT_EQ(words.size(), 0);
+    EXPECT_EQ(words.count(L"слово"), 0);
+
+    words.add(L"слово");
+    words.add(L"word", 3);
+    words.add(L"слово");
+    EXPECT_EQ(words.size(), 2);
+    EXPECT_EQ(words.count(L"слово"), 2);
+    EXPECT_EQ(words.count(L"word"), 3);
+    EXPECT_EQ(words.count(L"wor"), 0);
+    EXPECT_EQ(words.count(L"words"), 0);
+}
+
+// Тест перестроения таблицы при заполнении больше чем наполовину
+TEST(WordTableTest, Rehash) {
+    WordTable words;
+    const int n = 5000;
+    for (int i = 0; i < n; i++) {
+        words.add(std::to_wstring(i), i % 7 + 1);
+    }
+    for (int i = 0; i < n; i += 2) {
+        words.add(std::to_wstring(i));
+    }
+    EXPECT_EQ(words.size(), n);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(words.count(std::to_wstring(i)), i % 7 + 1 + (i % 2 == 0));
+    }
+    EXPECT_EQ(words.count(std::to_wstring(n)), 0);
+}
+
+// Тест слияния таблиц
+TEST(WordTableTest, Merge) {
+    WordTable a;
+    a.add(L"один");
+    a.add(L"два", 2);
+    WordTable b;
+    b.add(L"два", 5);
+    b.add(L"три", 3);
+    for (int i = 0; i < 2000; i++) {
+        b.add(L"w" + std::to_wstring(i));
+    }
+
+    a.merge(b);
+    EXPECT_EQ(a.size(), 2003);
+    EXPECT_EQ(a.count(L"один"), 1);
+    EXPECT_EQ(a.count(L"два"), 7);
+    EXPECT_EQ(a.count(L"три"), 3);
+    EXPECT_EQ(a.count(L"w1999"), 1);
+    // Слитая таблица не меняется
+    EXPECT_EQ(b.count(L"два"), 5);
+    EXPECT_EQ(b.size(), 2002);
+
+    WordTable empty;
+    a.merge(empty);
+    empty.merge(a);
+    EXPECT_EQ(a.size(), 2003);
+    EXPECT_EQ(empty.size(), 2003);
+    EXPECT_EQ(empty.count(L"два"), 7);
+}
+
+// Тест порядка слов: по убыванию частоты, равные - в обратном порядке
+TEST(WordTableTest, SortedOrder) {
+    WordTable words;
+    words.add(L"b", 2);
+    words.add(L"a", 2);
+    words.add(L"c", 2);
+    words.add(L"z", 1);
+    words.add(L"yy", 5);
+    words.add(L"ab", 2);
+
+    auto sorted = words.sorted();
+    ASSERT_EQ(sorted.size(), 6);
+    const wchar_t *order[] = {L"yy", L"c", L"b", L"ab", L"a", L"z"};
+    const long counts[] = {5, 2, 2, 2, 2, 1};
+    for (size_t i = 0; i < sorted.size(); i++) {
+        EXPECT_EQ(sorted[i].first, order[i]);
+        EXPECT_EQ(sorted[i].second, counts[i]);
+    }
+    EXPECT_TRUE(WordTable().sorted().empty());
+}
+
+// Тест слов длиннее блока памяти для ключей
+TEST(WordTableTest, LongWords) {
+    WordTable words;
+    std::wstring shorter(1000, L'к');
+    // Заполняет первый блок так, что следующее слово в него не помещается
+    for (int i = 0; i < 70; i++) {
+        words.add(shorter + std::to_wstring(i));
+    }
+    std::wstring longer(70000, L'д');
+    std::wstring longest(200000, L'x');
+    words.add(longer);
+    words.add(longest, 2);
+    words.add(L"после");
+    words.add(longer);
+
+    EXPECT_EQ(words.size(), 73);
+    EXPECT_EQ(words.count(longer), 2);
+    EXPECT_EQ(words.count(longest), 2);
+    EXPECT_EQ(words.count(L"после"), 1);
+    for (int i = 0; i < 70; i++) {
+        EXPECT_EQ(words.count(shorter + std::to_wstring(i)), 1);
+    }
+
+    // Частоты равны, и 'д' идёт после 'x'
+    auto sorted = words.sorted();
+    EXPECT_EQ(sorted[0].first, longer);
+    EXPECT_EQ(sorted[1].first, longest);
+}
@@ -0,0 +1,217 @@
+// Одни и те же нагрузки для всех реализаций BitArray. Файл собирается
+// отдельно с каждой библиотекой: BIT_ARRAY_HEADER задаёт заголовок, а
+// BIT_ARRAY_BACKEND - имя реализации в названиях бенчмарков.
+#include BIT_ARRAY_HEADER
+#include "bit_alloc.h"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+// Размеры от 64 бит до 1 Гбит
+constexpr int64_t min_bits = 64;
+constexpr int64_t max_bits = int64_t{1} << 30;
+
+// Произвольный доступ - от 128 Кбайт, помещающихся в кэш, до 2 Гбайт
+constexpr int64_t min_random_bits = int64_t{1} << 20;
+constexpr int64_t max_random_bits = int64_t{1} << 34;
+constexpr int64_t random_accesses = 1 << 16;
+
+BitArray make_random(size_t size, uint64_t seed) {
+    BitArray bits(size);
+    uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+    size_t head = std::min<size_t>(size, 4096);
+    for (size_t i = 0; i < head; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        bits.set(i, x & 1);
+    }
+    // Остальное заполняется копиями начала, удваивая заполненную часть
+    for (size_t filled = head; filled < size; filled *= 2) {
+        bits |= bits << filled;
+    }
+    return bits;
+}
+
+void set_bytes(benchmark::State &state) {
+    state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+void Construct(benchmark::State &state) {
+    for (auto _ : state) {
+        BitArray bits(state.range(0));
+        benchmark::DoNotOptimize(bits);
+    }
+    set_bytes(state);
+}
+
+void PushBack(benchmark::State &state) {
+    for (auto _ : state) {
+        BitArray bits;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            bits.push_back(i % 3 == 0);
+        }
+        benchmark::DoNotOptimize(bits);
+    }
+    set_bytes(state);
+}
+
+void ShiftLeft(benchmark::State &state) {
+    BitArray bits = make_random(state.range(0), 1);
+    for (auto _ : state) {
+        bits <<= 13;
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state);
+}
+
+void ShiftRight(benchmark::State &state) {
+    BitArray bits = make_random(state.range(0), 1);
+    for (auto _ : state) {
+        bits >>= 13;
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state);
+}
+
+void And(benchmark::State &state) {
+    BitArray a = make_random(state.range(0), 1);
+    BitArray b = make_random(state.range(0), 2);
+    for (auto _ : state) {
+        a &= b;
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state);
+}
+
+void Or(benchmark::State &state) {
+    BitArray a = make_random(state.range(0), 1);
+    BitArray b = make_random(state.range(0), 2);
+    for (auto _ : state) {
+        a |= b;
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state);
+}
+
+void Xor(benchmark::State &state) {
+    BitArray a = make_random(state.range(0), 1);
+    BitArray b = make_random(state.range(0), 2);
+    for (auto _ : state) {
+        a ^= b;
+        benchmark::ClobberMemory();
+    }
+    set_bytes(state);
+}
+
+void Not(benchmark::State &state) {
+    BitArray a = make_random(state.range(0), 1);
+    for (auto _ : state) {
+        BitArray res = ~a;
+        benchmark::DoNotOptimize(res);
+    }
+    set_bytes(state);
+}
+
+void Count(benchmark::State &state) {
+    BitArray bits = make_random(state.range(0), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bits.count());
+    }
+    set_bytes(state);
+}
+
+void ToString(benchmark::State &state) {
+    BitArray bits = make_random(state.range(0), 1);
+    for (auto _ : state) {
+        std::string text = bits.to_string();
+        benchmark::DoNotOptimize(text);
+    }
+    set_bytes(state);
+}
+
+void Equality(benchmark::State &state) {
+    // Равные массивы приходится сравнивать целиком
+    BitArray a = make_random(state.range(0), 1);
+    BitArray b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a == b);
+    }
+    set_bytes(state);
+}
+
+// Случайные set и operator[], в которых на больших массивах время
+// уходит на промахи TLB; сравнивается для разных распределителей памяти
+void RandomAccess(benchmark::State &state,
+                  const bit_alloc::Allocator *allocator) {
+    const bit_alloc::Allocator &previous = bit_alloc::active();
+    bit_alloc::use(*allocator);
+    BitArray bits(state.range(0));
+    bit_alloc::use(previous);
+    // Размер - степень двойки, так что индекс получается маской
+    uint64_t mask = state.range(0) - 1;
+    uint64_t x = 1;
+    for (auto _ : state) {
+        size_t found = 0;
+        for (int64_t i = 0; i < random_accesses; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            bits.set(x & mask);
+            found += bits[(x >> 32) & mask];
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * random_accesses);
+}
+
+struct Workload {
+    const char *name;
+    void (*run)(benchmark::State &);
+};
+
+constexpr Workload workloads[] = {
+    {"Construct", Construct}, {"PushBack", PushBack},
+    {"ShiftLeft", ShiftLeft}, {"ShiftRight", ShiftRight},
+    {"And", And},             {"Or", Or},
+    {"Xor", Xor},             {"Not", Not},
+    {"Count", Count},         {"ToString", ToString},
+    {"Equality", Equality},
+};
+
+void register_all() {
+    for (const Workload &workload : workloads) {
+        std::string name = std::string(BIT_ARRAY_BACKEND) + "/" + workload.name;
+        benchmark::RegisterBenchmark(name.c_str(), workload.run)
+            ->RangeMultiplier(64)
+            ->Range(min_bits, max_bits);
+    }
+    const bit_alloc::Allocator *allocators[] = {
+        &bit_alloc::aligned(), &bit_alloc::transparent_huge_pages(),
+        &bit_alloc::huge_pages()};
+    for (const bit_alloc::Allocator *allocator : allocators) {
+        std::string name = std::string(BIT_ARRAY_BACKEND) + "/RandomAccess/" +
+                           allocator->name;
+        benchmark::RegisterBenchmark(name.c_str(), RandomAccess, allocator)
+            ->RangeMultiplier(16)
+            ->Range(min_random_bits, max_random_bits);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    register_all();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("backend", BIT_ARRAY_BACKEND);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "bit_array.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+/*!
+ * A fixed-size bit array that many threads may update at once.
+ *
+ * Every operation is a single lock-free atomic operation on the 64-bit word
+ * holding the bit. Read-modify-write operations default to acq_rel ordering
+ * and loads to acquire, so a thread that sees a bit set also sees what the
+ * setter wrote before setting it. Callers that only need the bits themselves,
+ * such as a parallel traversal marking visited nodes, can pass
+ * std::memory_order_relaxed.
+ *
+ * The size is fixed at construction; use `snapshot()` to get a BitArray for
+ * everything else.
+ */
+class AtomicBitArray {
+public:
+    AtomicBitArray() = default;
+
+    /*!
+     * Construct an AtomicBitArray of `num_bits` zero bits.
+     * @param num_bits The number of bits in the new AtomicBitArray.
+     */
+    explicit AtomicBitArray(size_t num_bits);
+
+    /*!
+     * Construct an AtomicBitArray with the contents of `bits`.
+     * @param bits The BitArray to copy from.
+     */
+    explicit AtomicBitArray(const BitArray &bits);
+
+    AtomicBitArray(AtomicBitArray &&b) noexcept;
+    AtomicBitArray &operator=(AtomicBitArray &&b) noexcept;
+
+    /*!
+     * Set the bit at `n` to true.
+     * @param n The index of the bit to set.
+     * @param order The memory order of the update.
+     */
+    void set(size_t n, std::memory_order order = std::memory_order_acq_rel) {
+        word_at(n).fetch_or(bit(n), order);
+    }
+
+    /*!
+     * Reset the bit at `n` to false.
+     * @param n The index of the bit to reset.
+     * @param order The memory order of the update.
+     */
+    void reset(size_t n, std::memory_order order = std::memory_order_acq_rel) {
+        word_at(n).fetch_and(~bit(n), order);
+    }
+
+    /*!
+     * Set the bit at `n` and return its previous value. Exactly one of the
+     * threads racing to set a bit sees false.
+     * @param n The index of the bit to set.
+     * @param order The memory order of the update.
+     */
+    bool test_and_set(size_t n,
+                      std::memory_order order = std::memory_order_acq_rel) {
+        std::atomic<uint64_t> &word = word_at(n);
+        // Skipping the write when the bit is already set keeps the cache line
+        // shared between the cores that only read it.
+        std::memory_order load_order = order == std::memory_order_relaxed
+                                           ? std::memory_order_relaxed
+                                           : std::memory_order_acquire;
+        if (word.load(load_order) & bit(n)) {
+            return true;
+        }
+        return word.fetch_or(bit(n), order) & bit(n);
+    }
+
+    /*!
+     * Returns the value of the bit at `n`.
+     * @param n The index of the bit to get.
+     * @param order The memory order of the load.
+     */
+    bool test(size_t n,
+              std::memory_order order = std::memory_order_acquire) const {
+        return word_at(n).load(order) & bit(n);
+    }
+
+    /*!
+     * OR `mask` into the word at `i` and return the previous word. Bits of
+     * `mask` past `size()` are ignored.
+     * @param i The index of the word.
+     * @param mask The bits to set.
+     * @param order The memory order of the update.
+     */
+    uint64_t fetch_or(size_t i, uint64_t mask,
+                      std::memory_order order = std::memory_order_acq_rel);
+
+    /*!
+     * AND `mask` into the word at `i` and return the previous word.
+     * @param i The index of the word.
+     * @param mask The bits to keep.
+     * @param order The memory order of the update.
+     */
+    uint64_t fetch_and(size_t i, uint64_t mask,
+                       std::memory_order order = std::memory_order_acq_rel);
+
+    /*!
+     * Returns the word at `i`.
+     * @param i The index of the word.
+     * @param order The memory order of the load.
+     */
+    uint64_t load_word(
+        size_t i, std::memory_order order = std::memory_order_acquire) const;
+
+    /*!
+     * Returns the number of bits that are set. Concurrent updates may or may
+     * not be counted.
+     */
+    size_t count() const;
+
+    /*!
+     * Reset all the bits. Must not run concurrently with other updates.
+     */
+    void reset();
+
+    /*!
+     * Returns the number of bits in the array.
+     */
+    size_t size() const;
+
+    /*!
+     * Returns the number of 64-bit words in the array.
+     */
+    size_t num_words() const;
+
+    /*!
+     * Copy the contents into a BitArray. Each word is read atomically, but
+     * words updated during the copy may be seen before or after the update.
+     */
+    BitArray snapshot() const;
+
+private:
+    static uint64_t bit(size_t n) { return uint64_t{1} << (n % 64); }
+
+    std::atomic<uint64_t> &word_at(size_t n) const {
+        if (n >= bits_size) {
+            throw std::invalid_argument("Error: bit index out of range");
+        }
+        return words[n / 64];
+    }
+
+    size_t bits_size{};
+    std::unique_ptr<std::atomic<uint64_t>[]> words{};
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+
+/*!
+ * The memory behind the heap blocks of the BitArray implementations.
+ *
+ * Every block comes from the active Allocator, which `use()` replaces. The
+ * built-in allocators all return memory aligned to `alignment`, a cache
+ * line, and differ in the pages behind large blocks: random access over a
+ * bitmap of gigabytes misses the TLB on almost every access with 4 KiB
+ * pages, and far less often with 2 MiB ones.
+ *
+ * A block is freed by the allocator that made it, so `use()` may be called
+ * at any time; it affects the blocks allocated after it.
+ */
+namespace bit_alloc {
+
+/*!
+ * The alignment of the memory returned by the built-in allocators.
+ */
+constexpr size_t alignment = 64;
+
+/*!
+ * The huge page size the huge page allocators round large blocks up to. A
+ * block of whole huge pages and at most `alignment` bytes more, as a bit_cow
+ * block of whole huge pages is with its header, maps the extra bytes in a
+ * small page in front of the huge pages and not in another huge page.
+ */
+constexpr size_t huge_page_size = size_t{2} << 20;
+
+/*!
+ * A source of block memory. `deallocate` is passed the byte count that was
+ * passed to `allocate`. Allocators are used through pointers and must
+ * outlive their blocks.
+ */
+struct Allocator {
+    const char *name;
+    // Returns `bytes` bytes aligned to `alignment`, or throws
+    // std::bad_alloc.
+    void *(*allocate)(size_t bytes);
+    void (*deallocate)(void *p, size_t bytes);
+};
+
+/*!
+ * Returns the default allocator: the global operator new with `alignment`.
+ */
+const Allocator &aligned();
+
+/*!
+ * Returns an allocator that maps blocks of at least `huge_page_size` bytes
+ * on huge page boundaries and asks the kernel to back them with transparent
+ * huge pages. Smaller blocks, and all blocks where the system has no such
+ * mapping calls, come from `aligned()`.
+ */
+const Allocator &transparent_huge_pages();
+
+/*!
+ * Returns an allocator that maps blocks of at least `huge_page_size` bytes
+ * from the reserved huge pages of the system (MAP_HUGETLB), falling back to
+ * `transparent_huge_pages()` when none are free.
+ */
+const Allocator &huge_pages();
+
+/*!
+ * Make `allocator` the source of all new blocks.
+ * @param allocator The allocator to use.
+ */
+void use(const Allocator &allocator);
+
+/*!
+ * Returns the allocator new blocks come from.
+ */
+const Allocator &active();
+
+} // namespace bit_alloc
@@ -1,12 +1,26 @@
 #pragma once
 
+#include "bit_expression.h"
+#include "word_buffer.h"
+
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <iosfwd>
+#include <iterator>
+#include <limits>
 #include <string>
-#include <vector>
 
 class BitArray {
 public:
+    class SetBitIterator;
+    class SetBitRange;
+
+    /*!
+     * Returned by the find functions when there is no such bit.
+     */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
     BitArray() = default;
     ~BitArray() = default;
 
@@ -26,6 +40,23 @@ public:
      */
     BitArray(const BitArray &b);
 
+    /*!
+     * Evaluate the expression `e` into a new BitArray in a single pass.
+     * @param e The expression to evaluate.
+     */
+    template <bit_expr::Expression E>
+    BitArray(const E &e) : bits_size(e.size()), words(word_count(bits_size)) {
+        for (size_t i = 0; i < words.size(); i++) {
+            words[i] = e.word(i);
+        }
+    }
+
+    /*!
+     * Move the contents of `b` into this BitArray, leaving `b` empty.
+     * @param b The BitArray to move from.
+     */
+    BitArray(BitArray &&b) noexcept;
+
     /*!
      * Swap the contents of this BitArray with `b`.
      * @param b The BitArray to swap with.
@@ -38,6 +69,34 @@ public:
      */
     BitArray &operator=(const BitArray &b);
 
+    /*!
+     * Evaluate the expression `e` into this BitArray in a single pass. When
+     * the result keeps the current size this is done in place, even if `e`
+     * reads this BitArray.
+     * @param e The expression to evaluate.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator=(const E &e) {
+        if (e.size() != bits_size && e.aliases(this)) {
+            BitArray res(e);
+            swap(res);
+            return *this;
+        }
+        bits_size = e.size();
+        words.detach();
+        words.resize(word_count(bits_size));
+        for (size_t i = 0; i < words.size(); i++) {
+            words[i] = e.word(i);
+        }
+        return *this;
+    }
+
+    /*!
+     * Move the contents of `b` into this BitArray, leaving `b` empty.
+     * @param b The BitArray to move from.
+     */
+    BitArray &operator=(BitArray &&b) noexcept;
+
     /*!
      * Resize the BitArray to `num_bits` bits and initialize the new bits to
      * `value`. If `num_bits` is less than the current number of bits, any
@@ -50,7 +109,25 @@ public:
     void resize(size_t num_bits, bool value = false);
 
     /*!
-     * Clear the BitArray, removing all bits.
+     * Make room for at least `num_bits` bits without changing the size, so
+     * that growing up to that size does not reallocate.
+     * @param num_bits The number of bits to reserve room for.
+     */
+    void reserve(size_t num_bits);
+
+    /*!
+     * Returns the number of bits the BitArray can hold without reallocating.
+     */
+    size_t capacity() const;
+
+    /*!
+     * Release storage that is not needed for the current size.
+     */
+    void shrink_to_fit();
+
+    /*!
+     * Clear the BitArray, removing all bits. The storage is kept; call
+     * `shrink_to_fit()` to release it.
      */
     void clear();
 
@@ -83,6 +160,33 @@ public:
      */
     BitArray &operator^=(const BitArray &b);
 
+    /*!
+     * AND the result of the expression `e` into the current BitArray.
+     * @param e The expression to AND with.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator&=(const E &e) {
+        return *this = *this & e;
+    }
+
+    /*!
+     * OR the result of the expression `e` into the current BitArray.
+     * @param e The expression to OR with.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator|=(const E &e) {
+        return *this = *this | e;
+    }
+
+    /*!
+     * XOR the result of the expression `e` into the current BitArray.
+     * @param e The expression to XOR with.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator^=(const E &e) {
+        return *this = *this ^ e;
+    }
+
     /*!
      * Shift the bits in the current BitArray to the left by `n`.
      * @param n The number of bits to shift by.
@@ -133,6 +237,28 @@ public:
      */
     BitArray &reset();
 
+    /*!
+     * Set the `len` bits starting at `pos` to `val`.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     * @param val The value to set the bits to. Defaults to true.
+     */
+    BitArray &set_range(size_t pos, size_t len, bool val = true);
+
+    /*!
+     * Reset the `len` bits starting at `pos` to false.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    BitArray &reset_range(size_t pos, size_t len);
+
+    /*!
+     * Invert the `len` bits starting at `pos`.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    BitArray &flip_range(size_t pos, size_t len);
+
     /*!
      * Returns true if any of the bits are set.
      */
@@ -144,15 +270,31 @@ public:
     bool none() const;
 
     /*!
-     * Create a new BitArray with the bits inverted.
+     * Returns true if any of the `len` bits starting at `pos` are set.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    bool any_range(size_t pos, size_t len) const;
+
+    /*!
+     * Returns true if none of the `len` bits starting at `pos` are set.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
      */
-    BitArray operator~() const;
+    bool none_range(size_t pos, size_t len) const;
 
     /*!
      * Returns the number of bits that are set.
      */
     size_t count() const;
 
+    /*!
+     * Returns the number of set bits among the `len` bits starting at `pos`.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    size_t count_range(size_t pos, size_t len) const;
+
     /*!
      * Returns the value of the bit at `i`.
      * @param n The index of the bit to get.
@@ -169,11 +311,88 @@ public:
      */
     bool empty() const;
 
+    /*!
+     * Returns the index of the first set bit, or `npos` if there is none.
+     */
+    size_t find_first() const;
+
+    /*!
+     * Returns the index of the first set bit after `pos`, or `npos` if there
+     * is none.
+     * @param pos The index to search after.
+     */
+    size_t find_next(size_t pos) const;
+
+    /*!
+     * Returns the index of the last set bit, or `npos` if there is none.
+     */
+    size_t find_last() const;
+
+    /*!
+     * Returns a range over the indices of the set bits, in increasing order.
+     * Its iterators are invalidated by any change to the BitArray.
+     */
+    SetBitRange set_bits() const;
+
+    /*!
+     * Call `f` with the index of every set bit, in increasing order.
+     * @param f The function to call.
+     */
+    template <class F>
+    void for_each_set(F &&f) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            for (word_type word = words[i]; word != 0; word &= word - 1) {
+                f(i * word_bits + std::countr_zero(word));
+            }
+        }
+    }
+
+    /*!
+     * Returns a pointer to the underlying 64-bit words. Bit `i` is bit
+     * `i % 64` of word `i / 64`; bits past `size()` in the last word are
+     * always zero.
+     */
+    const uint64_t *data() const;
+
+    /*!
+     * Returns a pointer to the underlying 64-bit words for writing, first
+     * copying them if they are shared with a copy (see bit_cow.h). Callers
+     * must leave the bits past `size()` in the last word zero.
+     */
+    uint64_t *data();
+
+    /*!
+     * Returns the number of 64-bit words behind `data()`.
+     */
+    size_t num_words() const;
+
     /*!
      * Returns a string representation of the current BitArray.
      */
     std::string to_string() const;
 
+    /*!
+     * Parse a string of '0' and '1' characters, last bit first, as returned
+     * by `to_string()`.
+     * @param s The string to parse.
+     */
+    static BitArray from_string(const std::string &s);
+
+    /*!
+     * Write the bits of `b` to `os` as '0' and '1' characters, as hex digits
+     * after `std::hex`, or as raw binary after `bit_text::rawbits`.
+     * @param os The stream to write to.
+     * @param b The BitArray to write.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const BitArray &b);
+
+    /*!
+     * Read a BitArray from `is` in the format written by `operator<<`.
+     * @param is The stream to read from.
+     * @param b The BitArray to read into.
+     */
+    friend std::istream &operator>>(std::istream &is, BitArray &b);
+
     /*!
      * Compare two BitArrays for equality.
      * @param a The first BitArray to compare.
@@ -190,27 +409,105 @@ public:
      */
     friend bool operator!=(const BitArray &a, const BitArray &b);
 
+private:
+    using word_type = uint64_t;
+    static constexpr size_t word_bits = std::numeric_limits<word_type>::digits;
+
     /*!
-     * AND the bits in `b1` and `b2`.
-     * @param b1 The first BitArray to AND.
-     * @param b2 The second BitArray to AND.
+     * Returns the number of words needed to store `num_bits` bits.
      */
-    friend BitArray operator&(const BitArray &b1, const BitArray &b2);
+    static size_t word_count(size_t num_bits);
 
     /*!
-     * OR the bits in `b1` and `b2`.
-     * @param b1 The first BitArray to OR.
-     * @param b2 The second BitArray to OR.
+     * Throw if the `len` bits starting at `pos` do not fit in the BitArray.
      */
-    friend BitArray operator|(const BitArray &b1, const BitArray &b2);
+    void check_range(size_t pos, size_t len) const;
 
     /*!
-     * XOR the bits in `b1` and `b2`.
-     * @param b1 The first BitArray to XOR.
-     * @param b2 The second BitArray to XOR.
+     * Zero the bits of the last word that lie past `size()`. Every bulk
+     * operation relies on these bits staying zero.
      */
-    friend BitArray operator^(const BitArray &b1, const BitArray &b2);
+    void clear_unused_bits();
+
+    size_t bits_size{};
+    WordBuffer words{};
+};
+
+template <>
+inline constexpr bool bit_expr::is_leaf<BitArray> = true;
+
+/*!
+ * A forward iterator over the indices of the set bits of a BitArray. It skips
+ * whole zero words, so walking a sparse array costs time proportional to its
+ * set bits and its word count, not to its bit count.
+ */
+class BitArray::SetBitIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const size_t *;
+    using reference = size_t;
+
+    SetBitIterator() = default;
+
+    size_t operator*() const {
+        return index * word_bits + std::countr_zero(word);
+    }
+
+    SetBitIterator &operator++() {
+        word &= word - 1;
+        skip_zero_words();
+        return *this;
+    }
+
+    SetBitIterator operator++(int) {
+        SetBitIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    friend bool operator==(const SetBitIterator &a, const SetBitIterator &b) {
+        return a.index == b.index && a.word == b.word;
+    }
+
+private:
+    friend class BitArray;
+
+    SetBitIterator(const word_type *words, size_t num_words, size_t index)
+        : words(words), num_words(num_words), index(index),
+          word(index < num_words ? words[index] : 0) {
+        skip_zero_words();
+    }
+
+    void skip_zero_words() {
+        while (word == 0 && index < num_words) {
+            if (++index < num_words) {
+                word = words[index];
+            }
+        }
+    }
+
+    const word_type *words{};
+    size_t num_words{};
+    size_t index{};
+    word_type word{};
+};
+
+/*!
+ * The range returned by `BitArray::set_bits()`.
+ */
+class BitArray::SetBitRange {
+public:
+    SetBitIterator begin() const { return {words, num_words, 0}; }
+    SetBitIterator end() const { return {words, num_words, num_words}; }
 
 private:
-    std::vector<bool> bits{};
+    friend class BitArray;
+
+    SetBitRange(const word_type *words, size_t num_words)
+        : words(words), num_words(num_words) {}
+
+    const word_type *words;
+    size_t num_words;
 };
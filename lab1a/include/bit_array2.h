@@ -1,7 +1,13 @@
 #pragma once
 
+#include "bit_expression.h"
+
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -26,6 +32,23 @@ public:
      */
     BitArray(const BitArray &b);
 
+    /*!
+     * Evaluate the expression `e` into a new BitArray in a single pass.
+     * @param e The expression to evaluate.
+     */
+    template <bit_expr::Expression E>
+    BitArray(const E &e) : BitArray(e.size()) {
+        for (size_t i = 0, n = e.num_words(); i < n; i++) {
+            store_word(i, e.word(i));
+        }
+    }
+
+    /*!
+     * Move the contents of `b` into this BitArray, leaving `b` empty.
+     * @param b The BitArray to move from.
+     */
+    BitArray(BitArray &&b) noexcept;
+
     /*!
      * Swap the contents of this BitArray with `b`.
      * @param b The BitArray to swap with.
@@ -38,6 +61,32 @@ public:
      */
     BitArray &operator=(const BitArray &b);
 
+    /*!
+     * Move the contents of `b` into this BitArray, leaving `b` empty.
+     * @param b The BitArray to move from.
+     */
+    BitArray &operator=(BitArray &&b) noexcept;
+
+    /*!
+     * Evaluate the expression `e` into this BitArray in a single pass. When
+     * the result keeps the current size this is done in place, even if `e`
+     * reads this BitArray.
+     * @param e The expression to evaluate.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator=(const E &e) {
+        if (e.size() != bits_size) {
+            BitArray res(e);
+            swap(res);
+            return *this;
+        }
+        detach();
+        for (size_t i = 0, n = e.num_words(); i < n; i++) {
+            store_word(i, e.word(i));
+        }
+        return *this;
+    }
+
     /*!
      * Resize the BitArray to `num_bits` bits and initialize the new bits to
      * `value`. If `num_bits` is less than the current number of bits, any
@@ -50,7 +99,25 @@ public:
     void resize(size_t num_bits, bool value = false);
 
     /*!
-     * Clear the BitArray, removing all bits.
+     * Make room for at least `num_bits` bits without changing the size, so
+     * that growing up to that size does not reallocate.
+     * @param num_bits The number of bits to reserve room for.
+     */
+    void reserve(size_t num_bits);
+
+    /*!
+     * Returns the number of bits the BitArray can hold without reallocating.
+     */
+    size_t capacity() const;
+
+    /*!
+     * Release storage that is not needed for the current size.
+     */
+    void shrink_to_fit();
+
+    /*!
+     * Clear the BitArray, removing all bits. The storage is kept; call
+     * `shrink_to_fit()` to release it.
      */
     void clear();
 
@@ -83,6 +150,33 @@ public:
      */
     BitArray &operator^=(const BitArray &b);
 
+    /*!
+     * AND the result of the expression `e` into the current BitArray.
+     * @param e The expression to AND with.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator&=(const E &e) {
+        return *this = *this & e;
+    }
+
+    /*!
+     * OR the result of the expression `e` into the current BitArray.
+     * @param e The expression to OR with.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator|=(const E &e) {
+        return *this = *this | e;
+    }
+
+    /*!
+     * XOR the result of the expression `e` into the current BitArray.
+     * @param e The expression to XOR with.
+     */
+    template <bit_expr::Expression E>
+    BitArray &operator^=(const E &e) {
+        return *this = *this ^ e;
+    }
+
     /*!
      * Shift the bits in the current BitArray to the left by `n`.
      * @param n The number of bits to shift by.
@@ -143,11 +237,6 @@ public:
      */
     bool none() const;
 
-    /*!
-     * Create a new BitArray with the bits inverted.
-     */
-    BitArray operator~() const;
-
     /*!
      * Returns the number of bits that are set.
      */
@@ -164,6 +253,27 @@ public:
      */
     size_t size() const;
 
+    /*!
+     * Returns bits `64 * i` to `64 * i + 63` as a word, the first bit in the
+     * lowest place, for the expressions of `bit_expression.h`.
+     * @param i The index of the word, below `(size() + 63) / 64`.
+     */
+    uint64_t word(size_t i) const {
+        size_t first = i * 8;
+        size_t n = std::min<size_t>(8, (bits_size + 7) / 8 - first);
+        uint64_t w = 0;
+        if constexpr (std::endian::native == std::endian::little) {
+            if (n == 8) {
+                std::memcpy(&w, bits + first, 8);
+                return w;
+            }
+        }
+        for (size_t k = 0; k < n; k++) {
+            w |= uint64_t{bits[first + k]} << (8 * k);
+        }
+        return w;
+    }
+
     /*!
      * Returns true if the current BitArray is empty.
      */
@@ -174,6 +284,28 @@ public:
      */
     std::string to_string() const;
 
+    /*!
+     * Parse a string of '0' and '1' characters, last bit first, as returned
+     * by `to_string()`.
+     * @param s The string to parse.
+     */
+    static BitArray from_string(const std::string &s);
+
+    /*!
+     * Write the bits of `b` to `os` as '0' and '1' characters, as hex digits
+     * after `std::hex`, or as raw binary after `bit_text::rawbits`.
+     * @param os The stream to write to.
+     * @param b The BitArray to write.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const BitArray &b);
+
+    /*!
+     * Read a BitArray from `is` in the format written by `operator<<`.
+     * @param is The stream to read from.
+     * @param b The BitArray to read into.
+     */
+    friend std::istream &operator>>(std::istream &is, BitArray &b);
+
     /*!
      * Compare two BitArrays for equality.
      * @param a The first BitArray to compare.
@@ -190,28 +322,60 @@ public:
      */
     friend bool operator!=(const BitArray &a, const BitArray &b);
 
+private:
+    // Arrays of up to this many bytes live inside the object itself.
+    static constexpr size_t inline_bytes = 16;
+
     /*!
-     * AND the bits in `b1` and `b2`.
-     * @param b1 The first BitArray to AND.
-     * @param b2 The second BitArray to AND.
+     * Returns storage for `bytes` bytes: the inline buffer if it is big
+     * enough, a new heap block otherwise.
      */
-    friend BitArray operator&(const BitArray &b1, const BitArray &b2);
+    unsigned char *allocate(size_t bytes);
 
     /*!
-     * OR the bits in `b1` and `b2`.
-     * @param b1 The first BitArray to OR.
-     * @param b2 The second BitArray to OR.
+     * Move the contents to storage of `new_capacity` bytes.
      */
-    friend BitArray operator|(const BitArray &b1, const BitArray &b2);
+    void reallocate(size_t new_capacity);
 
     /*!
-     * XOR the bits in `b1` and `b2`.
-     * @param b1 The first BitArray to XOR.
-     * @param b2 The second BitArray to XOR.
+     * Drop this array's reference to `bits` if it is on the heap.
      */
-    friend BitArray operator^(const BitArray &b1, const BitArray &b2);
+    void release();
+
+    /*!
+     * Give the array a heap block of its own if it shares one, before the
+     * bits are written to.
+     */
+    void detach();
+
+    /*!
+     * Store `w` as word `i` of the bits, as read by `word()`.
+     */
+    void store_word(size_t i, uint64_t w) {
+        size_t first = i * 8;
+        size_t n = std::min<size_t>(8, (bits_size + 7) / 8 - first);
+        if constexpr (std::endian::native == std::endian::little) {
+            if (n == 8) {
+                std::memcpy(bits + first, &w, 8);
+                return;
+            }
+        }
+        for (size_t k = 0; k < n; k++) {
+            bits[first + k] = static_cast<unsigned char>(w >> (8 * k));
+        }
+    }
+
+    /*!
+     * Zero the bits of the last byte that lie past `size()`. Bulk operations
+     * compare and scan whole bytes, so these bits must stay zero.
+     */
+    void clear_unused_bits();
 
-private:
     size_t bits_size{};
+    size_t capacity_bytes{inline_bytes};
     unsigned char *bits{};
+    unsigned char inline_bits[inline_bytes]{};
 };
+
+template <>
+inline constexpr bool bit_expr::is_leaf<BitArray> = true;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "bit_alloc.h"
+
+#include <atomic>
+#include <cstddef>
+
+/*!
+ * Opt-in copy-on-write storage for the BitArray implementations.
+ *
+ * The heap buffers of a BitArray are reference-counted blocks, whose memory
+ * comes from the active `bit_alloc` allocator. After
+ * `enable()`, copying a BitArray shares its block instead of copying the
+ * bits, and the first call that modifies either copy (`set`, `reset`, `&=`,
+ * `resize` and so on) gives that copy a private block first. While the mode
+ * is off, copies get blocks of their own as before; blocks already shared
+ * stay shared until written to.
+ *
+ * The reference count is atomic, so copies that share a block may be used
+ * and modified from different threads, like independent arrays. Making a
+ * writable pointer or view, such as from a non-const `data()`, a BitSpan or
+ * a BitMatrix row or column, gives the array a private block; but one made
+ * before the array was copied points into the shared block and must not be
+ * written through after the copy. Make it again instead.
+ */
+namespace bit_cow {
+
+namespace detail {
+
+inline std::atomic<bool> on{false};
+
+// Precedes the data of every block; its size keeps the data aligned as the
+// memory from the allocator.
+struct alignas(bit_alloc::alignment) Header {
+    std::atomic<size_t> refs;
+    // The block size and source, for freeing it.
+    size_t bytes;
+    const bit_alloc::Allocator *allocator;
+};
+
+inline Header *header(const void *data) {
+    return static_cast<Header *>(const_cast<void *>(data)) - 1;
+}
+
+} // namespace detail
+
+/*!
+ * Turn copy-on-write on for copies made from now on.
+ */
+void enable();
+
+/*!
+ * Turn copy-on-write off for copies made from now on.
+ */
+void disable();
+
+/*!
+ * Returns true if copies share their blocks.
+ */
+inline bool enabled() { return detail::on.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the data of a new block of `bytes` bytes with one reference,
+ * aligned to `bit_alloc::alignment`.
+ */
+void *allocate(size_t bytes);
+
+/*!
+ * Add a reference to the block with data `data` and return `data`.
+ */
+void *share(void *data);
+
+/*!
+ * Drop a reference to the block with data `data`, freeing it with the last
+ * one. Does nothing for a null pointer.
+ */
+void release(void *data);
+
+/*!
+ * Returns true if the block with data `data` has other references, and so
+ * must be copied before it is written to.
+ */
+inline bool shared(const void *data) {
+    // Acquire pairs with the release of the other references, so that their
+    // last reads of the block happen before this copy writes to it.
+    return detail::header(data)->refs.load(std::memory_order_acquire) != 1;
+}
+
+} // namespace bit_cow
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * Lazy expressions over bit arrays.
+ *
+ * `a & b`, `a | b`, `a ^ b` and `~a` do not compute anything. They build a
+ * small expression object that holds references to the arrays it reads, and
+ * the whole expression is evaluated word by word, in a single pass, when it is
+ * assigned to a BitArray or when `count()`, `any()` or `none()` is called on
+ * it. Expressions must not outlive the arrays they refer to, so do not keep
+ * them in `auto` variables past the end of the statement that built them.
+ *
+ * Because the operators return expressions rather than BitArrays, only the
+ * members above can be called on their result directly. Convert it first
+ * for anything else: `BitArray(a & b).to_string()` rather than
+ * `(a & b).to_string()`, and `BitArray r = a & b; r.set(0);` rather than
+ * `auto r = a & b;`, which would hold references to `a` and `b` instead of
+ * bits. Indexing, `to_string()` and the other members of BitArray do not
+ * compile on an expression.
+ *
+ * As with the compound operators, the result has the size of the left
+ * operand, and bits past the end of the shorter operand are taken from the
+ * left operand unchanged.
+ */
+namespace bit_expr {
+
+constexpr size_t word_bits = std::numeric_limits<uint64_t>::digits;
+
+inline size_t word_count(size_t num_bits) {
+    return (num_bits + word_bits - 1) / word_bits;
+}
+
+/*!
+ * Returns a mask of the bits below `num_bits` in word `i`.
+ */
+inline uint64_t prefix_mask(size_t num_bits, size_t i) {
+    if (num_bits >= (i + 1) * word_bits) {
+        return ~uint64_t{0};
+    }
+    if (num_bits <= i * word_bits) {
+        return 0;
+    }
+    return (uint64_t{1} << (num_bits % word_bits)) - 1;
+}
+
+/*!
+ * Set to true for the array types that may appear as expression leaves. They
+ * must provide `size()`, and either `word(i)` or `data()` returning 64-bit
+ * words, with zero bits past `size()` in the last word.
+ */
+template <class T>
+inline constexpr bool is_leaf = false;
+
+template <class T>
+concept Leaf = is_leaf<T>;
+
+template <class T>
+concept Expression = requires(const T &e, size_t i, const void *p) {
+    typename T::is_bit_expression;
+    { e.size() } -> std::convertible_to<size_t>;
+    { e.word(i) } -> std::convertible_to<uint64_t>;
+    { e.aliases(p) } -> std::convertible_to<bool>;
+};
+
+template <class T>
+concept Operand = Leaf<T> || Expression<T>;
+
+/*!
+ * Reductions shared by all expression nodes.
+ */
+template <class Derived>
+class Base {
+public:
+    using is_bit_expression = void;
+
+    size_t num_words() const { return word_count(self().size()); }
+
+    /*!
+     * Returns the number of bits that are set in the result.
+     */
+    size_t count() const {
+        size_t cnt = 0;
+        for (size_t i = 0, n = num_words(); i < n; i++) {
+            cnt += std::popcount(self().word(i));
+        }
+        return cnt;
+    }
+
+    /*!
+     * Returns true if any bit of the result is set.
+     */
+    bool any() const {
+        for (size_t i = 0, n = num_words(); i < n; i++) {
+            if (self().word(i) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*!
+     * Returns true if no bit of the result is set.
+     */
+    bool none() const { return !any(); }
+
+private:
+    const Derived &self() const { return static_cast<const Derived &>(*this); }
+};
+
+template <Leaf T>
+class LeafRef : public Base<LeafRef<T>> {
+public:
+    explicit LeafRef(const T &bits) : bits(bits) {}
+
+    size_t size() const { return bits.size(); }
+    uint64_t word(size_t i) const {
+        if constexpr (requires { bits.word(i); }) {
+            return bits.word(i);
+        } else {
+            return bits.data()[i];
+        }
+    }
+    bool aliases(const void *p) const { return p == &bits; }
+
+private:
+    const T &bits;
+};
+
+template <Operand T>
+auto as_expression(const T &t) {
+    if constexpr (Expression<T>) {
+        return t;
+    } else {
+        return LeafRef<T>(t);
+    }
+}
+
+template <class T>
+using expression_t = decltype(as_expression(std::declval<const T &>()));
+
+struct And {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a & b; }
+};
+
+struct Or {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a | b; }
+};
+
+struct Xor {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a ^ b; }
+};
+
+template <class L, class R, class Op>
+class Binary : public Base<Binary<L, R, Op>> {
+public:
+    Binary(L l, R r)
+        : l(std::move(l)), r(std::move(r)),
+          common_bits(std::min(this->l.size(), this->r.size())),
+          full_words(common_bits / word_bits) {}
+
+    size_t size() const { return l.size(); }
+
+    uint64_t word(size_t i) const {
+        if (i < full_words) {
+            return Op::apply(l.word(i), r.word(i));
+        }
+        // Only the bits both operands have take part in the operation.
+        uint64_t mask = prefix_mask(common_bits, i);
+        uint64_t lw = l.word(i);
+        uint64_t rw = i < r.num_words() ? r.word(i) : 0;
+        return (Op::apply(lw, rw) & mask) | (lw & ~mask);
+    }
+
+    bool aliases(const void *p) const { return l.aliases(p) || r.aliases(p); }
+
+private:
+    L l;
+    R r;
+    size_t common_bits;
+    size_t full_words;
+};
+
+template <class E>
+class Not : public Base<Not<E>> {
+public:
+    explicit Not(E e)
+        : e(std::move(e)), last_word(this->num_words() - 1),
+          last_mask(prefix_mask(size(), last_word)) {}
+
+    size_t size() const { return e.size(); }
+
+    uint64_t word(size_t i) const {
+        return i == last_word ? ~e.word(i) & last_mask : ~e.word(i);
+    }
+
+    bool aliases(const void *p) const { return e.aliases(p); }
+
+private:
+    E e;
+    size_t last_word;
+    uint64_t last_mask;
+};
+
+} // namespace bit_expr
+
+/*!
+ * AND the bits in `a` and `b`.
+ * @param a The first operand.
+ * @param b The second operand.
+ */
+template <bit_expr::Operand L, bit_expr::Operand R>
+auto operator&(const L &a, const R &b) {
+    return bit_expr::Binary<bit_expr::expression_t<L>,
+                            bit_expr::expression_t<R>, bit_expr::And>(
+        bit_expr::as_expression(a), bit_expr::as_expression(b));
+}
+
+/*!
+ * OR the bits in `a` and `b`.
+ * @param a The first operand.
+ * @param b The second operand.
+ */
+template <bit_expr::Operand L, bit_expr::Operand R>
+auto operator|(const L &a, const R &b) {
+    return bit_expr::Binary<bit_expr::expression_t<L>,
+                            bit_expr::expression_t<R>, bit_expr::Or>(
+        bit_expr::as_expression(a), bit_expr::as_expression(b));
+}
+
+/*!
+ * XOR the bits in `a` and `b`.
+ * @param a The first operand.
+ * @param b The second operand.
+ */
+template <bit_expr::Operand L, bit_expr::Operand R>
+auto operator^(const L &a, const R &b) {
+    return bit_expr::Binary<bit_expr::expression_t<L>,
+                            bit_expr::expression_t<R>, bit_expr::Xor>(
+        bit_expr::as_expression(a), bit_expr::as_expression(b));
+}
+
+/*!
+ * Invert the bits in `a`.
+ * @param a The operand.
+ */
+template <bit_expr::Operand T>
+auto operator~(const T &a) {
+    return bit_expr::Not<bit_expr::expression_t<T>>(
+        bit_expr::as_expression(a));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace bit_kernels {
+
+/*!
+ * A set of bulk byte-buffer kernels for one instruction set. All pointers may
+ * be unaligned; `dst` may alias `src`.
+ */
+struct Kernels {
+    const char *name;
+    void (*and_bytes)(unsigned char *dst, const unsigned char *src, size_t n);
+    void (*or_bytes)(unsigned char *dst, const unsigned char *src, size_t n);
+    void (*xor_bytes)(unsigned char *dst, const unsigned char *src, size_t n);
+    void (*not_bytes)(unsigned char *dst, const unsigned char *src, size_t n);
+    bool (*any_bytes)(const unsigned char *src, size_t n);
+    bool (*equal_bytes)(const unsigned char *a, const unsigned char *b,
+                        size_t n);
+    size_t (*count_bytes)(const unsigned char *src, size_t n);
+    // The pair counts return the number of set bits of `a & b`, `a | b` or
+    // `a ^ b` without storing it; `and_or_count_bytes` returns that of
+    // `a & b` and stores that of `a | b` in `*or_count`, in a single pass.
+    size_t (*and_count_bytes)(const unsigned char *a, const unsigned char *b,
+                              size_t n);
+    size_t (*or_count_bytes)(const unsigned char *a, const unsigned char *b,
+                             size_t n);
+    size_t (*xor_count_bytes)(const unsigned char *a, const unsigned char *b,
+                              size_t n);
+    size_t (*and_or_count_bytes)(const unsigned char *a,
+                                 const unsigned char *b, size_t n,
+                                 size_t *or_count);
+};
+
+/*!
+ * Returns the fastest kernel set supported by the current CPU. The choice is
+ * made once, on first use.
+ */
+const Kernels &active();
+
+/*!
+ * Returns every kernel set the current CPU can run, scalar first.
+ */
+std::vector<const Kernels *> supported();
+
+} // namespace bit_kernels
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "bit_array.h"
+#include "bit_span.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * A read-only view of one column of a BitMatrix: bit `i` of the view is the
+ * bit of the column in row `i`.
+ *
+ * The view does not own the bits and must not outlive the matrix.
+ */
+class ConstBitColumn {
+public:
+    ConstBitColumn() = default;
+
+    /*!
+     * View bit `col` of `rows` rows of `stride` words each, starting at
+     * `words`.
+     * @param words The first word of the first row.
+     * @param stride The number of words per row.
+     * @param col The index of the column.
+     * @param rows The number of rows.
+     */
+    ConstBitColumn(const uint64_t *words, size_t stride, size_t col,
+                   size_t rows);
+
+    /*!
+     * Returns the number of bits in the view.
+     */
+    size_t size() const { return num_rows; }
+
+    /*!
+     * Returns the value of the bit in row `i`.
+     * @param i The index of the row.
+     */
+    bool operator[](size_t i) const {
+        return (words[i * stride] >> shift) & 1;
+    }
+
+    /*!
+     * Returns the number of bits that are set.
+     */
+    size_t count() const;
+
+    /*!
+     * Returns a new BitArray with the bits of the view.
+     */
+    BitArray to_bit_array() const;
+
+protected:
+    const uint64_t *words{};
+    size_t stride{};
+    size_t shift{};
+    size_t num_rows{};
+};
+
+/*!
+ * A view of one column of a BitMatrix that can also modify it in place.
+ */
+class BitColumn : public ConstBitColumn {
+public:
+    BitColumn() = default;
+
+    /*!
+     * View bit `col` of `rows` rows of `stride` words each, starting at
+     * `words`.
+     * @param words The first word of the first row.
+     * @param stride The number of words per row.
+     * @param col The index of the column.
+     * @param rows The number of rows.
+     */
+    BitColumn(uint64_t *words, size_t stride, size_t col, size_t rows);
+
+    /*!
+     * Set the bit in row `n` to `val`.
+     * @param n The index of the row.
+     * @param val The value to set the bit to. Defaults to true.
+     */
+    const BitColumn &set(size_t n, bool val = true) const;
+
+    /*!
+     * Reset the bit in row `n` to false.
+     * @param n The index of the row.
+     */
+    const BitColumn &reset(size_t n) const;
+
+    /*!
+     * Copy the bits of `src`, of the same size as the view, into the view.
+     * @param src The bits to copy.
+     */
+    const BitColumn &assign(const BitArray &src) const;
+};
+
+/*!
+ * A dense boolean matrix stored row by row in a single BitArray.
+ *
+ * Every row starts on a word boundary and is padded with zero bits to a whole
+ * number of words, so a row is a plain run of words that the BitArray and
+ * BitSpan word loops work on directly. Bit `(r, c)` is bit `c % 64` of word
+ * `r * stride() + c / 64` of `data()`.
+ *
+ * `transpose()` swaps 64x64 bit blocks with word shifts and masks instead of
+ * moving single bits, and the product works a whole row of words at a time,
+ * so a step of a transitive closure such as `r |= r * r` costs far less than
+ * `rows() * cols() * cols()` single bit lookups.
+ */
+class BitMatrix {
+public:
+    BitMatrix() = default;
+
+    /*!
+     * Construct a `rows` by `cols` matrix of zeros.
+     * @param rows The number of rows.
+     * @param cols The number of columns.
+     */
+    BitMatrix(size_t rows, size_t cols);
+
+    /*!
+     * Returns the `n` by `n` identity matrix.
+     * @param n The number of rows and columns.
+     */
+    static BitMatrix identity(size_t n);
+
+    /*!
+     * Returns the number of rows.
+     */
+    size_t rows() const;
+
+    /*!
+     * Returns the number of columns.
+     */
+    size_t cols() const;
+
+    /*!
+     * Returns the number of words per row.
+     */
+    size_t stride() const;
+
+    /*!
+     * Returns the bit at row `r` and column `c`. The indices are not
+     * checked.
+     * @param r The index of the row.
+     * @param c The index of the column.
+     */
+    bool operator()(size_t r, size_t c) const {
+        return (bits.data()[r * row_words + c / 64] >> (c % 64)) & 1;
+    }
+
+    /*!
+     * Set the bit at row `r` and column `c` to `val`.
+     * @param r The index of the row.
+     * @param c The index of the column.
+     * @param val The value to set the bit to. Defaults to true.
+     */
+    BitMatrix &set(size_t r, size_t c, bool val = true);
+
+    /*!
+     * Reset the bit at row `r` and column `c` to false.
+     * @param r The index of the row.
+     * @param c The index of the column.
+     */
+    BitMatrix &reset(size_t r, size_t c);
+
+    /*!
+     * Returns a view of row `r`.
+     * @param r The index of the row.
+     */
+    ConstBitSpan row(size_t r) const;
+
+    /*!
+     * Returns a view of row `r` that can modify it.
+     * @param r The index of the row.
+     */
+    BitSpan row(size_t r);
+
+    /*!
+     * Returns a view of column `c`.
+     * @param c The index of the column.
+     */
+    ConstBitColumn column(size_t c) const;
+
+    /*!
+     * Returns a view of column `c` that can modify it.
+     * @param c The index of the column.
+     */
+    BitColumn column(size_t c);
+
+    /*!
+     * Returns the number of bits that are set.
+     */
+    size_t count() const;
+
+    /*!
+     * Returns the transposed matrix.
+     */
+    BitMatrix transpose() const;
+
+    /*!
+     * OR the bits of `m`, of the same size, into the matrix.
+     * @param m The matrix to OR with.
+     */
+    BitMatrix &operator|=(const BitMatrix &m);
+
+    /*!
+     * Returns the boolean product of `a` and `b`: bit `(i, j)` is set if
+     * some `k` has both `a(i, k)` and `b(k, j)` set. `a.cols()` must equal
+     * `b.rows()`.
+     */
+    friend BitMatrix operator*(const BitMatrix &a, const BitMatrix &b);
+
+    /*!
+     * Compare two matrices.
+     */
+    friend bool operator==(const BitMatrix &a, const BitMatrix &b);
+
+    /*!
+     * Compare two matrices for inequality.
+     */
+    friend bool operator!=(const BitMatrix &a, const BitMatrix &b);
+
+    /*!
+     * Returns a pointer to the words of the matrix, `stride()` words per row.
+     */
+    const uint64_t *data() const;
+
+    /*!
+     * Returns a pointer to the words of the matrix, `stride()` words per row.
+     * Padding bits past `cols()` in each row must be left zero.
+     */
+    uint64_t *data();
+
+private:
+    void check_row(size_t r) const;
+    void check_column(size_t c) const;
+
+    size_t num_rows{};
+    size_t num_cols{};
+    size_t row_words{};
+    BitArray bits{};
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "bit_array.h"
+#include "bit_matrix.h"
+
+#include <cstddef>
+#include <span>
+
+/*!
+ * Similarity measures of two BitArrays of the same size, seen as sets of the
+ * indices of their set bits.
+ *
+ * Each one makes a single pass over the words of both arrays and counts the
+ * bits of `a & b`, `a | b` or `a ^ b` with popcount as it goes, so
+ * `hamming(a, b)` builds no `a ^ b` array. Arrays of different sizes throw
+ * `std::invalid_argument`.
+ *
+ * The `_many` functions score one query against every row of a BitMatrix,
+ * whose rows lie one after another in memory, and store the score of row `i`
+ * in `out[i]`.
+ */
+
+/*!
+ * Returns the number of bits that differ between `a` and `b`.
+ */
+size_t hamming(const BitArray &a, const BitArray &b);
+
+/*!
+ * Returns the number of bits set in both `a` and `b`.
+ */
+size_t intersect_count(const BitArray &a, const BitArray &b);
+
+/*!
+ * Returns the number of bits set in `a` or `b`.
+ */
+size_t union_count(const BitArray &a, const BitArray &b);
+
+/*!
+ * Returns the Jaccard similarity of `a` and `b`, the size of their
+ * intersection over that of their union, or 1 if both are empty.
+ */
+double jaccard(const BitArray &a, const BitArray &b);
+
+/*!
+ * Returns true if every bit set in `a` is also set in `b`.
+ */
+bool is_subset(const BitArray &a, const BitArray &b);
+
+/*!
+ * Store `hamming(query, row)` for every row of `batch` in `out`.
+ * @param query The array to compare, of `batch.cols()` bits.
+ * @param batch The arrays to compare with, one per row.
+ * @param out The results, one per row of `batch`.
+ */
+void hamming_many(const BitArray &query, const BitMatrix &batch,
+                  std::span<size_t> out);
+
+/*!
+ * Store `intersect_count(query, row)` for every row of `batch` in `out`.
+ * @param query The array to compare, of `batch.cols()` bits.
+ * @param batch The arrays to compare with, one per row.
+ * @param out The results, one per row of `batch`.
+ */
+void intersect_count_many(const BitArray &query, const BitMatrix &batch,
+                          std::span<size_t> out);
+
+/*!
+ * Store `union_count(query, row)` for every row of `batch` in `out`.
+ * @param query The array to compare, of `batch.cols()` bits.
+ * @param batch The arrays to compare with, one per row.
+ * @param out The results, one per row of `batch`.
+ */
+void union_count_many(const BitArray &query, const BitMatrix &batch,
+                      std::span<size_t> out);
+
+/*!
+ * Store `jaccard(query, row)` for every row of `batch` in `out`.
+ * @param query The array to compare, of `batch.cols()` bits.
+ * @param batch The arrays to compare with, one per row.
+ * @param out The results, one per row of `batch`.
+ */
+void jaccard_many(const BitArray &query, const BitMatrix &batch,
+                  std::span<double> out);
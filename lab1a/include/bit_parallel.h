@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+/*!
+ * Opt-in multi-threaded execution of BitArray bulk operations.
+ *
+ * After `enable()`, `count()`, `any()`, `none()`, `==`, `&=`, `|=` and `^=`
+ * on arrays of at least `Options::min_words` words split the words into
+ * chunks that start on cache line boundaries and run them on a shared thread
+ * pool. Smaller arrays, and all arrays while parallel mode is off, run on the
+ * calling thread as before.
+ *
+ * `enable()` and `disable()` must not be called while other threads use
+ * BitArrays.
+ */
+namespace bit_parallel {
+
+struct Options {
+    // The number of threads, counting the caller. 0 means one per hardware
+    // thread.
+    size_t threads = 0;
+    // Arrays with fewer words are processed on the calling thread. The
+    // default of 1 MiB is well above the cost of waking the pool.
+    size_t min_words = size_t{1} << 17;
+};
+
+/*!
+ * Turn parallel mode on, starting a thread pool.
+ * @param options The number of threads and the size threshold.
+ */
+void enable(const Options &options = {});
+
+/*!
+ * Turn parallel mode off and stop the thread pool.
+ */
+void disable();
+
+/*!
+ * Returns true if parallel mode is on.
+ */
+bool enabled();
+
+namespace detail {
+
+inline std::atomic<size_t> min_words{std::numeric_limits<size_t>::max()};
+
+void for_each(const void *base, size_t num_words,
+              const std::function<void(size_t, size_t)> &body);
+size_t sum(const void *base, size_t num_words,
+           const std::function<size_t(size_t, size_t)> &body);
+
+} // namespace detail
+
+/*!
+ * Returns true if an array of `num_words` words should be split.
+ */
+inline bool use(size_t num_words) {
+    return num_words >= detail::min_words.load(std::memory_order_relaxed);
+}
+
+/*!
+ * Call `body(first, last)` on half-open word ranges that together cover the
+ * `num_words` words at `base`, in parallel when `use(num_words)`.
+ */
+template <class Body>
+void for_each(const void *base, size_t num_words, Body body) {
+    if (use(num_words)) {
+        detail::for_each(base, num_words, body);
+    } else {
+        body(0, num_words);
+    }
+}
+
+/*!
+ * Returns the sum of `body(first, last)` over half-open word ranges that
+ * together cover the `num_words` words at `base`, computed in parallel when
+ * `use(num_words)`.
+ */
+template <class Body>
+size_t sum(const void *base, size_t num_words, Body body) {
+    if (use(num_words)) {
+        return detail::sum(base, num_words, body);
+    }
+    return body(0, num_words);
+}
+
+} // namespace bit_parallel
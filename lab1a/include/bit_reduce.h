@@ -0,0 +1,38 @@
+#pragma once
+
+#include "bit_array.h"
+
+#include <cstddef>
+#include <span>
+
+/*!
+ * Combine many BitArrays of the same size in one pass.
+ *
+ * Instead of folding the inputs pairwise, which writes and rereads a whole
+ * temporary array per input, the output is built a block of words at a time:
+ * every input is read for that block while the block stays in the L1 cache,
+ * and each block of the output is written to memory once. Inputs of different
+ * sizes throw `std::invalid_argument`; with no inputs the result is empty.
+ */
+
+/*!
+ * Returns the AND of all of `arrays`. A block whose running AND becomes
+ * zero skips the remaining inputs.
+ * @param arrays The arrays to combine.
+ */
+BitArray and_all(std::span<const BitArray *const> arrays);
+
+/*!
+ * Returns the OR of all of `arrays`.
+ * @param arrays The arrays to combine.
+ */
+BitArray or_all(std::span<const BitArray *const> arrays);
+
+/*!
+ * Returns the bits set in at least `k` of `arrays`. The counts are kept in
+ * bit-sliced form, one word per bit of the count, so 64 bits are counted
+ * with a few word operations per input.
+ * @param arrays The arrays to combine.
+ * @param k The number of inputs a bit must be set in.
+ */
+BitArray at_least_k(std::span<const BitArray *const> arrays, size_t k);
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "bit_array.h"
+#include "bit_expression.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * A read-only view of `size()` consecutive bits starting at any bit offset
+ * of a word buffer, such as the words of a BitArray.
+ *
+ * The view does not own the words and must not outlive them, or a resize of
+ * the BitArray it looks into. Bit `i` of the view is bit `offset + i` of the
+ * buffer, so the view need not start on a word boundary; `word(i)` returns
+ * the view's bits realigned to start at bit 0.
+ *
+ * A ConstBitSpan is a bit expression, so `BitArray r = span & other;` and
+ * `BitArray copy = span;` work without an intermediate copy.
+ */
+class ConstBitSpan : public bit_expr::Base<ConstBitSpan> {
+public:
+    /*!
+     * Returned by the find functions when there is no such bit.
+     */
+    static constexpr size_t npos = BitArray::npos;
+
+    ConstBitSpan() = default;
+
+    /*!
+     * View `size` bits of `words` starting at bit `offset`.
+     * @param words The word buffer.
+     * @param offset The index of the first bit of the view in the buffer.
+     * @param size The number of bits in the view.
+     */
+    ConstBitSpan(const uint64_t *words, size_t offset, size_t size);
+
+    /*!
+     * View all the bits of `bits`.
+     * @param bits The BitArray to view.
+     */
+    ConstBitSpan(const BitArray &bits);
+
+    /*!
+     * View the `len` bits of `bits` starting at `pos`.
+     * @param bits The BitArray to view.
+     * @param pos The index of the first bit of the view.
+     * @param len The number of bits in the view.
+     */
+    ConstBitSpan(const BitArray &bits, size_t pos, size_t len);
+
+    ConstBitSpan(const BitArray &&bits) = delete;
+    ConstBitSpan(const BitArray &&bits, size_t pos, size_t len) = delete;
+
+    /*!
+     * Returns a view of the `len` bits of this view starting at `pos`.
+     * @param pos The index of the first bit of the new view.
+     * @param len The number of bits in the new view.
+     */
+    ConstBitSpan subspan(size_t pos, size_t len) const;
+
+    /*!
+     * Returns the number of bits in the view.
+     */
+    size_t size() const { return bits_size; }
+
+    /*!
+     * Returns true if the view has no bits.
+     */
+    bool empty() const { return bits_size == 0; }
+
+    /*!
+     * Returns the value of the bit at `i`.
+     * @param i The index of the bit to get.
+     */
+    bool operator[](size_t i) const {
+        size_t bit = offset + i;
+        return (words[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    /*!
+     * Returns bits `64 * i` to `64 * i + 63` of the view, with zeros past the
+     * end of the view.
+     * @param i The index of the word.
+     */
+    uint64_t word(size_t i) const {
+        size_t bit = offset + 64 * i;
+        size_t w = bit / 64;
+        size_t shift = bit % 64;
+        uint64_t res = words[w] >> shift;
+        if (shift != 0 && (w + 1) * 64 < offset + bits_size) {
+            res |= words[w + 1] << (64 - shift);
+        }
+        return res & bit_expr::prefix_mask(bits_size, i);
+    }
+
+    /*!
+     * Returns true if the view looks into `p`.
+     */
+    bool aliases(const void *p) const { return p != nullptr && p == owner; }
+
+    /*!
+     * Returns the number of bits that are set.
+     */
+    size_t count() const;
+
+    /*!
+     * Returns the index of the first set bit, or `npos` if there is none.
+     */
+    size_t find_first() const;
+
+    /*!
+     * Returns the index of the first set bit after `pos`, or `npos` if there
+     * is none.
+     * @param pos The index to search after.
+     */
+    size_t find_next(size_t pos) const;
+
+    /*!
+     * Returns a new BitArray with the bits of the view.
+     */
+    BitArray to_bit_array() const;
+
+    /*!
+     * Compare the bits of two views.
+     */
+    friend bool operator==(const ConstBitSpan &a, const ConstBitSpan &b);
+
+    /*!
+     * Compare the bits of two views for inequality.
+     */
+    friend bool operator!=(const ConstBitSpan &a, const ConstBitSpan &b);
+
+    /*!
+     * Compare the bits of a view and a BitArray.
+     */
+    friend bool operator==(const ConstBitSpan &a, const BitArray &b);
+
+protected:
+    // The BitArray the view was made from, if any, for `aliases()`.
+    const void *owner{};
+    // `offset` is below 64: whole words are skipped by advancing `words`.
+    const uint64_t *words{};
+    size_t offset{};
+    size_t bits_size{};
+};
+
+/*!
+ * A view of consecutive bits that can also modify them in place.
+ *
+ * The logic operations read another view of the same or a different buffer
+ * and, as with BitArray, work on the first `min(size(), src.size())` bits.
+ * The source must not overlap the destination unless they are the same
+ * bits.
+ */
+class BitSpan : public ConstBitSpan {
+public:
+    BitSpan() = default;
+
+    /*!
+     * View `size` bits of `words` starting at bit `offset`.
+     * @param words The word buffer.
+     * @param offset The index of the first bit of the view in the buffer.
+     * @param size The number of bits in the view.
+     */
+    BitSpan(uint64_t *words, size_t offset, size_t size);
+
+    /*!
+     * View all the bits of `bits`.
+     * @param bits The BitArray to view.
+     */
+    BitSpan(BitArray &bits);
+
+    /*!
+     * View the `len` bits of `bits` starting at `pos`.
+     * @param bits The BitArray to view.
+     * @param pos The index of the first bit of the view.
+     * @param len The number of bits in the view.
+     */
+    BitSpan(BitArray &bits, size_t pos, size_t len);
+
+    /*!
+     * Returns a view of the `len` bits of this view starting at `pos`.
+     * @param pos The index of the first bit of the new view.
+     * @param len The number of bits in the new view.
+     */
+    BitSpan subspan(size_t pos, size_t len) const;
+
+    /*!
+     * Set the bit at `n` to `val`.
+     * @param n The index of the bit to set.
+     * @param val The value to set the bit to. Defaults to true.
+     */
+    const BitSpan &set(size_t n, bool val = true) const;
+
+    /*!
+     * Set all the bits of the view to true.
+     */
+    const BitSpan &set() const;
+
+    /*!
+     * Reset the bit at `n` to false.
+     * @param n The index of the bit to reset.
+     */
+    const BitSpan &reset(size_t n) const;
+
+    /*!
+     * Reset all the bits of the view to false.
+     */
+    const BitSpan &reset() const;
+
+    /*!
+     * Invert all the bits of the view.
+     */
+    const BitSpan &flip() const;
+
+    /*!
+     * Copy the bits of `src` into the view.
+     * @param src The bits to copy.
+     */
+    const BitSpan &assign(const ConstBitSpan &src) const;
+
+    /*!
+     * AND the bits of `src` into the view.
+     * @param src The bits to AND with.
+     */
+    const BitSpan &operator&=(const ConstBitSpan &src) const;
+
+    /*!
+     * OR the bits of `src` into the view.
+     * @param src The bits to OR with.
+     */
+    const BitSpan &operator|=(const ConstBitSpan &src) const;
+
+    /*!
+     * XOR the bits of `src` into the view.
+     * @param src The bits to XOR with.
+     */
+    const BitSpan &operator^=(const ConstBitSpan &src) const;
+
+private:
+    /*!
+     * Replace the bits of word `i` of the view selected by `mask` with those
+     * of `value`.
+     */
+    void store(size_t i, uint64_t value, uint64_t mask) const;
+
+    /*!
+     * Store `op(word(i), src.word(i))` into every word of the view shared
+     * with `src`.
+     */
+    template <class Op>
+    void combine(const ConstBitSpan &src, Op op) const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ios>
+#include <iosfwd>
+
+/*!
+ * Text and stream formats shared by the BitArray implementations. All of
+ * them see the bits as a little-endian byte buffer, bit `i` being bit `i % 8`
+ * of byte `i / 8`, with the bits past the size zero.
+ *
+ * BitArrays are written to streams as '0' and '1' characters, last bit first
+ * as in `to_string()`, or as hexadecimal digits when `std::hex` is set on the
+ * stream. Hex output starts with the bit count in decimal and a colon, as in
+ * `13:1671`, so that the size reads back exactly; an empty array is written
+ * as `0:` in either format, as it has no digits to form a token. After
+ * `bit_text::rawbits` they are written as raw binary instead: the bit count
+ * as a little-endian 64-bit integer followed by the bytes, padded with zeros
+ * to a multiple of 8.
+ *
+ * Reading accepts the same format the stream would write, from the next
+ * whitespace-delimited token, so every array reads back as it was written.
+ * A token with a count must have exactly the digits for it, with the bits
+ * past the count zero; a hex token of `d` digits without one reads as
+ * `4 * d` bits.
+ */
+namespace bit_text {
+
+/*!
+ * Write `num_bits` '0' and '1' characters for the bits in `bytes` to `out`,
+ * last bit first.
+ */
+void to_chars(const unsigned char *bytes, size_t num_bits, char *out);
+
+/*!
+ * Parse the `num_bits` characters at `in`, last bit first, into the zeroed
+ * `bytes`. Returns false if a character is neither '0' nor '1'.
+ */
+bool from_chars(const char *in, size_t num_bits, unsigned char *bytes);
+
+/*!
+ * Stream manipulator that switches BitArray input and output to raw binary.
+ */
+std::ios_base &rawbits(std::ios_base &s);
+
+/*!
+ * Stream manipulator that switches BitArray input and output back to text.
+ */
+std::ios_base &norawbits(std::ios_base &s);
+
+/*!
+ * Write the `num_bits` bits in `bytes` to `os` in the format set on `os`.
+ */
+std::ostream &write(std::ostream &os, const unsigned char *bytes,
+                    size_t num_bits);
+
+/*!
+ * Read bits from `is` in the format set on `is`. Once the input has been
+ * parsed, `allocate(num_bits)` must return a zeroed buffer for that many
+ * bits. Sets failbit on `is`, without calling `allocate`, if the input is
+ * not valid.
+ *
+ * Raw input is read straight into the buffer after its header. Its bit
+ * count is checked against the bytes left in a seekable stream; a stream of
+ * unknown size that ends early is found only after `allocate`, which is
+ * then called again with 0 before failbit is set.
+ */
+std::istream &read(std::istream &is,
+                   const std::function<unsigned char *(size_t)> &allocate);
+
+} // namespace bit_text
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "bit_array.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/*!
+ * A cache-line-blocked Bloom filter stored in a BitArray.
+ *
+ * Each key hashes to one 512-bit block, which is one cache line, and sets or
+ * tests all of its bits inside that block, so a lookup costs a single cache
+ * miss. Blocks fill unevenly, which raises the false positive rate over that
+ * of a classic Bloom filter of the same size; the constructor accounts for
+ * this when it picks the number of bits and hash functions.
+ *
+ * `insert_many` and `contains_many` hash a batch of keys and prefetch their
+ * blocks before touching any of them, so the cache misses of the batch
+ * overlap instead of following each other.
+ */
+class BloomFilter {
+public:
+    /*!
+     * Construct an empty filter sized for `expected_keys` keys.
+     * @param expected_keys The number of keys the filter is sized for.
+     * @param false_positive_rate The wanted probability that `contains`
+     * returns true for a key that was not inserted, between 0 and 1.
+     */
+    BloomFilter(size_t expected_keys, double false_positive_rate);
+
+    /*!
+     * Insert `key` into the filter.
+     * @param key The key to insert.
+     */
+    void insert(uint64_t key);
+
+    /*!
+     * Insert the string `key` into the filter.
+     * @param key The key to insert.
+     */
+    void insert(std::string_view key);
+
+    /*!
+     * Returns false if `key` was never inserted, and true if it probably was.
+     * @param key The key to look up.
+     */
+    bool contains(uint64_t key) const;
+
+    /*!
+     * Returns false if the string `key` was never inserted, and true if it
+     * probably was.
+     * @param key The key to look up.
+     */
+    bool contains(std::string_view key) const;
+
+    /*!
+     * Insert all of `keys`.
+     * @param keys The keys to insert.
+     */
+    void insert_many(std::span<const uint64_t> keys);
+
+    /*!
+     * Look up all of `keys`, storing the result for `keys[i]` in
+     * `results[i]`.
+     * @param keys The keys to look up.
+     * @param results The results, of the same size as `keys`.
+     */
+    void contains_many(std::span<const uint64_t> keys,
+                       std::span<bool> results) const;
+
+    /*!
+     * Remove all keys.
+     */
+    void clear();
+
+    /*!
+     * Returns the number of bits of the filter.
+     */
+    size_t num_bits() const;
+
+    /*!
+     * Returns the number of bits set per key.
+     */
+    size_t num_hashes() const;
+
+private:
+    static constexpr size_t block_words = 8;
+
+    /*!
+     * Returns the index in `bits` of the first word of the block of the key
+     * hash `h`.
+     */
+    size_t block_offset(uint64_t h) const;
+
+    /*!
+     * Returns the first word of the block of the key hash `h`.
+     */
+    const uint64_t *block(uint64_t h) const;
+    uint64_t *block(uint64_t h);
+
+    // Extra words at the start of `bits` put block 0 on a cache line
+    // boundary.
+    BitArray bits{};
+    size_t first_word{};
+    size_t num_blocks{};
+    size_t hashes{};
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "bit_array.h"
+#include "bit_expression.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/*!
+ * A bit array stored in a memory-mapped file.
+ *
+ * The file starts with a 64-byte header holding a magic tag, the word size,
+ * the bit length and a checksum of the words, followed by the words exactly
+ * as BitArray keeps them in memory. Opening a file only maps it, so even a
+ * multi-gigabyte array is ready at once and its pages are read on first use.
+ *
+ * Opening does not verify the checksum, since that would read the whole file;
+ * call `verify()` for that. In read-write mode edits go straight to the
+ * mapped pages, and `flush()` (or the destructor, if anything changed)
+ * refreshes the checksum and writes the pages back with msync.
+ *
+ * A MappedBitArray can be used as an operand of BitArray expressions, so
+ * `BitArray r = mapped & other;` reads the file pages directly.
+ */
+class MappedBitArray {
+public:
+    enum class Mode { read_only, read_write };
+
+    /*!
+     * Map an existing file.
+     * @param path The file to open.
+     * @param mode Whether the array may be modified. Defaults to read-only.
+     */
+    explicit MappedBitArray(const std::string &path,
+                            Mode mode = Mode::read_only);
+
+    /*!
+     * Create a file holding `num_bits` zero bits and map it for writing.
+     * @param path The file to create. An existing file is replaced.
+     * @param num_bits The number of bits in the array.
+     */
+    static MappedBitArray create(const std::string &path, size_t num_bits);
+
+    /*!
+     * Write the contents of `bits` to a new file at `path`.
+     * @param bits The BitArray to save.
+     * @param path The file to write. An existing file is replaced.
+     */
+    static void save(const BitArray &bits, const std::string &path);
+
+    MappedBitArray(MappedBitArray &&b) noexcept;
+    MappedBitArray &operator=(MappedBitArray &&b) noexcept;
+    MappedBitArray(const MappedBitArray &) = delete;
+    MappedBitArray &operator=(const MappedBitArray &) = delete;
+    ~MappedBitArray();
+
+    /*!
+     * Evaluate the expression or bit array `e` into the mapped words. It must
+     * have the same size as the array.
+     * @param e The expression to evaluate.
+     */
+    template <bit_expr::Operand E>
+    MappedBitArray &operator=(const E &e) {
+        auto expr = bit_expr::as_expression(e);
+        if (expr.size() != bits_size) {
+            throw std::invalid_argument("Error: expression size mismatch");
+        }
+        uint64_t *words = mutable_data();
+        for (size_t i = 0; i < num_words(); i++) {
+            words[i] = expr.word(i);
+        }
+        return *this;
+    }
+
+    /*!
+     * Set the bit at `n` to `val`.
+     * @param n The index of the bit to set.
+     * @param val The value to set the bit to. Defaults to true.
+     */
+    MappedBitArray &set(size_t n, bool val = true);
+
+    /*!
+     * Reset the bit at `n` to false.
+     * @param n The index of the bit to reset.
+     */
+    MappedBitArray &reset(size_t n);
+
+    /*!
+     * Returns the value of the bit at `i`.
+     * @param i The index of the bit to get.
+     */
+    bool operator[](size_t i) const;
+
+    /*!
+     * Returns the number of bits that are set.
+     */
+    size_t count() const;
+
+    /*!
+     * Returns true if any of the bits are set.
+     */
+    bool any() const;
+
+    /*!
+     * Returns true if none of the bits are set.
+     */
+    bool none() const;
+
+    /*!
+     * Returns the number of bits in the array.
+     */
+    size_t size() const;
+
+    /*!
+     * Returns the number of 64-bit words behind `data()`.
+     */
+    size_t num_words() const;
+
+    /*!
+     * Returns a pointer to the mapped words for reading.
+     */
+    const uint64_t *data() const;
+
+    /*!
+     * Returns a pointer to the mapped words for writing, and marks the array
+     * changed so that `flush()` refreshes the checksum. Throws in read-only
+     * mode. Callers must leave the bits past `size()` in the last word zero.
+     */
+    uint64_t *mutable_data();
+
+    /*!
+     * Returns true if the array was opened for writing.
+     */
+    bool writable() const;
+
+    /*!
+     * Copy the contents into a new in-memory BitArray.
+     */
+    BitArray to_bit_array() const;
+
+    /*!
+     * Refresh the checksum and write all changes back to the file.
+     */
+    void flush();
+
+    /*!
+     * Returns true if the checksum in the header matches the words.
+     */
+    bool verify() const;
+
+private:
+    void unmap();
+
+    // The whole file is mapped: the header at `base`, then the words.
+    unsigned char *base{};
+    size_t mapped_bytes{};
+    size_t bits_size{};
+    Mode mode{Mode::read_only};
+    // Set by mutable_data(), through which every write goes, and cleared by
+    // flush().
+    bool dirty{};
+};
+
+template <>
+inline constexpr bool bit_expr::is_leaf<MappedBitArray> = true;
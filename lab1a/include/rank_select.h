@@ -0,0 +1,64 @@
+#pragma once
+
+#include "bit_array.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * A succinct rank/select index over a BitArray.
+ *
+ * The index reads the words of the BitArray it was built from, so that array
+ * must outlive the index and must not be modified while the index is in use.
+ * It adds about 25% of the array size for rank and a little more for the
+ * select samples.
+ */
+class RankSelect {
+public:
+    /*!
+     * Build the index over `bits`.
+     * @param bits The BitArray to index.
+     */
+    explicit RankSelect(const BitArray &bits);
+
+    /*!
+     * Returns the number of set bits before position `i`.
+     * @param i The position to count up to, at most `size()`.
+     */
+    size_t rank(size_t i) const;
+
+    /*!
+     * Returns the position of the set bit with index `k`, counting from 0.
+     * @param k The index of the set bit to find, less than `count()`.
+     */
+    size_t select(size_t k) const;
+
+    /*!
+     * Returns the number of set bits in the indexed BitArray.
+     */
+    size_t count() const;
+
+    /*!
+     * Returns the number of bits in the indexed BitArray.
+     */
+    size_t size() const;
+
+private:
+    /*!
+     * Returns the number of set bits in the first `sub` words of `block`.
+     */
+    size_t block_rank(size_t block, size_t sub) const;
+
+    const uint64_t *words;
+    size_t num_words;
+    size_t bits_size;
+    size_t ones{};
+
+    // For every block of 8 words, the number of set bits before the block
+    // followed by seven packed 9-bit counts of set bits inside the block.
+    std::vector<uint64_t> counts{};
+
+    // The block holding every 512th set bit.
+    std::vector<size_t> samples{};
+};
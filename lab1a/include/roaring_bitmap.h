@@ -0,0 +1,175 @@
+#pragma once
+
+#include "bit_array.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace roaring_detail {
+
+// Each container holds the low 16 bits of the values in one 64K chunk.
+constexpr size_t chunk_bits = 65536;
+constexpr size_t chunk_words = chunk_bits / 64;
+
+// Above this many values an array container is larger than a bitmap.
+constexpr size_t array_max = 4096;
+
+enum class Kind : uint8_t { array, bitmap, run };
+
+struct Container {
+    Kind kind = Kind::array;
+    uint32_t cardinality = 0;
+    // Array: the sorted values. Run: pairs of first and last value of every
+    // run of set bits, sorted.
+    std::vector<uint16_t> values{};
+    // Bitmap: `chunk_words` words.
+    std::vector<uint64_t> words{};
+};
+
+} // namespace roaring_detail
+
+/*!
+ * A compressed bitmap over 32-bit ids in the style of Roaring bitmaps.
+ *
+ * The id space is split into 64K chunks and every non-empty chunk is stored
+ * in the smallest of three containers: a sorted array of values for sparse
+ * chunks, a plain 8 KiB bitmap for dense ones, or a list of runs for chunks
+ * made of long runs. Operations work chunk by chunk and pick the container of
+ * the result from its contents.
+ */
+class RoaringBitmap {
+public:
+    RoaringBitmap() = default;
+
+    /*!
+     * Build a RoaringBitmap with the set bits of `bits`.
+     * @param bits The BitArray to compress. It must have at most 2^32 bits.
+     */
+    explicit RoaringBitmap(const BitArray &bits);
+
+    /*!
+     * Returns a BitArray of `num_bits` bits with the ids below `num_bits` set.
+     * @param num_bits The size of the new BitArray.
+     */
+    BitArray to_bit_array(size_t num_bits) const;
+
+    /*!
+     * Returns a BitArray just large enough to hold the largest id.
+     */
+    BitArray to_bit_array() const;
+
+    /*!
+     * Set the id `n` to `val`.
+     * @param n The id to set.
+     * @param val The value to set the id to. Defaults to true.
+     */
+    RoaringBitmap &set(uint32_t n, bool val = true);
+
+    /*!
+     * Set the `len` ids starting at `pos`. Whole chunks become a single run.
+     * @param pos The first id of the range.
+     * @param len The number of ids in the range.
+     */
+    RoaringBitmap &set_range(uint32_t pos, uint64_t len);
+
+    /*!
+     * Reset the id `n`.
+     * @param n The id to reset.
+     */
+    RoaringBitmap &reset(uint32_t n);
+
+    /*!
+     * Reset all the ids.
+     */
+    RoaringBitmap &reset();
+
+    /*!
+     * Returns true if the id `n` is set.
+     * @param n The id to test.
+     */
+    bool operator[](uint32_t n) const;
+
+    /*!
+     * Returns the number of ids that are set.
+     */
+    size_t count() const;
+
+    /*!
+     * Returns true if any of the ids are set.
+     */
+    bool any() const;
+
+    /*!
+     * Returns true if none of the ids are set.
+     */
+    bool none() const;
+
+    /*!
+     * Convert every container to the smallest representation, including run
+     * containers.
+     */
+    void run_optimize();
+
+    /*!
+     * Returns the approximate number of bytes used by the bitmap.
+     */
+    size_t memory_usage() const;
+
+    /*!
+     * AND the ids in `b` with the current RoaringBitmap.
+     * @param b The RoaringBitmap to AND with.
+     */
+    RoaringBitmap &operator&=(const RoaringBitmap &b);
+
+    /*!
+     * OR the ids in `b` with the current RoaringBitmap.
+     * @param b The RoaringBitmap to OR with.
+     */
+    RoaringBitmap &operator|=(const RoaringBitmap &b);
+
+    /*!
+     * XOR the ids in `b` with the current RoaringBitmap.
+     * @param b The RoaringBitmap to XOR with.
+     */
+    RoaringBitmap &operator^=(const RoaringBitmap &b);
+
+    /*!
+     * Compare two RoaringBitmaps for equality of their ids.
+     */
+    friend bool operator==(const RoaringBitmap &a, const RoaringBitmap &b);
+
+    /*!
+     * Compare two RoaringBitmaps for inequality of their ids.
+     */
+    friend bool operator!=(const RoaringBitmap &a, const RoaringBitmap &b);
+
+    /*!
+     * AND the ids in `a` and `b`.
+     */
+    friend RoaringBitmap operator&(const RoaringBitmap &a,
+                                   const RoaringBitmap &b);
+
+    /*!
+     * OR the ids in `a` and `b`.
+     */
+    friend RoaringBitmap operator|(const RoaringBitmap &a,
+                                   const RoaringBitmap &b);
+
+    /*!
+     * XOR the ids in `a` and `b`.
+     */
+    friend RoaringBitmap operator^(const RoaringBitmap &a,
+                                   const RoaringBitmap &b);
+
+private:
+    /*!
+     * Returns the position of `key` in `keys`, or where it would be inserted.
+     */
+    size_t find_key(uint16_t key) const;
+
+    // The high 16 bits of the ids in each container, sorted, and the
+    // containers themselves. Empty containers are never stored.
+    std::vector<uint16_t> keys{};
+    std::vector<roaring_detail::Container> containers{};
+};
@@ -0,0 +1,494 @@
+#pragma once
+
+#include "bit_array.h"
+#include "bit_expression.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/*!
+ * A bit array whose size `N` is known at compile time.
+ *
+ * It has the interface of BitArray without the resizing functions. The bits
+ * are stored inline in a std::array of 64-bit words, and every function
+ * except the two BitArray conversions is constexpr, so masks can be built in
+ * constant expressions. The conversions are not: BitArray keeps its words in
+ * a heap block from a run-time `bit_alloc` allocator, behind a reference
+ * counted bit_cow header, so no BitArray can exist in a constant
+ * expression. Loops run over a constant number of words, so the compiler
+ * unrolls them for small `N`.
+ *
+ * As in BitArray, the bits past `N` in the last word are always zero. A
+ * StaticBitArray can be used as an operand of BitArray expressions, and it
+ * converts to and from BitArray by copying words.
+ */
+template <size_t N>
+class StaticBitArray {
+public:
+    /*!
+     * Returned by the find functions when there is no such bit.
+     */
+    static constexpr size_t npos = BitArray::npos;
+
+    constexpr StaticBitArray() = default;
+
+    /*!
+     * Construct a StaticBitArray with `value` in the first 64 bits. The
+     * remaining bits are initialized to 0.
+     * @param value The value to initialize the first 64 bits with.
+     */
+    constexpr explicit StaticBitArray(uint64_t value) {
+        if constexpr (num_words_ > 0) {
+            words[0] = value;
+            clear_unused_bits();
+        }
+    }
+
+    /*!
+     * Construct a StaticBitArray with the first `N` bits of `b`. Bits past the
+     * end of `b` are initialized to 0.
+     * @param b The BitArray to copy from.
+     */
+    explicit StaticBitArray(const BitArray &b) {
+        std::copy_n(b.data(), std::min(num_words_, b.num_words()),
+                    words.begin());
+        clear_unused_bits();
+    }
+
+    /*!
+     * Returns a BitArray of `N` bits with the same contents.
+     */
+    BitArray to_bit_array() const {
+        BitArray res(N);
+        std::copy(words.begin(), words.end(), res.data());
+        return res;
+    }
+
+    /*!
+     * AND the bits in `b` with the current StaticBitArray.
+     * @param b The StaticBitArray to AND with.
+     */
+    constexpr StaticBitArray &operator&=(const StaticBitArray &b) {
+        for (size_t i = 0; i < num_words_; i++) {
+            words[i] &= b.words[i];
+        }
+        return *this;
+    }
+
+    /*!
+     * OR the bits in `b` with the current StaticBitArray.
+     * @param b The StaticBitArray to OR with.
+     */
+    constexpr StaticBitArray &operator|=(const StaticBitArray &b) {
+        for (size_t i = 0; i < num_words_; i++) {
+            words[i] |= b.words[i];
+        }
+        return *this;
+    }
+
+    /*!
+     * XOR the bits in `b` with the current StaticBitArray.
+     * @param b The StaticBitArray to XOR with.
+     */
+    constexpr StaticBitArray &operator^=(const StaticBitArray &b) {
+        for (size_t i = 0; i < num_words_; i++) {
+            words[i] ^= b.words[i];
+        }
+        return *this;
+    }
+
+    /*!
+     * Shift the bits in the current StaticBitArray to the left by `n`.
+     * @param n The number of bits to shift by.
+     */
+    constexpr StaticBitArray &operator<<=(size_t n) {
+        if (n >= N) {
+            return reset();
+        }
+        size_t word_shift = n / word_bits;
+        size_t bit_shift = n % word_bits;
+        for (size_t i = num_words_; i-- > word_shift;) {
+            uint64_t word = words[i - word_shift] << bit_shift;
+            if (bit_shift != 0 && i > word_shift) {
+                word |= words[i - word_shift - 1] >> (word_bits - bit_shift);
+            }
+            words[i] = word;
+        }
+        std::fill_n(words.begin(), word_shift, 0);
+        clear_unused_bits();
+        return *this;
+    }
+
+    /*!
+     * Shift the bits in the current StaticBitArray to the right by `n`.
+     * @param n The number of bits to shift by.
+     */
+    constexpr StaticBitArray &operator>>=(size_t n) {
+        if (n >= N) {
+            return reset();
+        }
+        size_t word_shift = n / word_bits;
+        size_t bit_shift = n % word_bits;
+        for (size_t i = 0; i + word_shift < num_words_; i++) {
+            uint64_t word = words[i + word_shift] >> bit_shift;
+            if (bit_shift != 0 && i + word_shift + 1 < num_words_) {
+                word |= words[i + word_shift + 1] << (word_bits - bit_shift);
+            }
+            words[i] = word;
+        }
+        std::fill(words.end() - word_shift, words.end(), 0);
+        return *this;
+    }
+
+    /*!
+     * Create a new StaticBitArray with the bits shifted to the left by `n`.
+     * @param n The number of bits to shift by.
+     */
+    constexpr StaticBitArray operator<<(size_t n) const {
+        StaticBitArray res = *this;
+        res <<= n;
+        return res;
+    }
+
+    /*!
+     * Create a new StaticBitArray with the bits shifted to the right by `n`.
+     * @param n The number of bits to shift by.
+     */
+    constexpr StaticBitArray operator>>(size_t n) const {
+        StaticBitArray res = *this;
+        res >>= n;
+        return res;
+    }
+
+    /*!
+     * Set the bit at `n` to `val`.
+     * @param n The index of the bit to set.
+     * @param val The value to set the bit to. Defaults to true.
+     */
+    constexpr StaticBitArray &set(size_t n, bool val = true) {
+        if (n >= N) {
+            throw std::invalid_argument("Error: bit index out of range");
+        }
+        uint64_t mask = uint64_t{1} << (n % word_bits);
+        if (val) {
+            words[n / word_bits] |= mask;
+        } else {
+            words[n / word_bits] &= ~mask;
+        }
+        return *this;
+    }
+
+    /*!
+     * Set all the bits to true.
+     */
+    constexpr StaticBitArray &set() {
+        words.fill(~uint64_t{0});
+        clear_unused_bits();
+        return *this;
+    }
+
+    /*!
+     * Reset the bit at `n` to false.
+     * @param n The index of the bit to reset.
+     */
+    constexpr StaticBitArray &reset(size_t n) { return set(n, false); }
+
+    /*!
+     * Reset all the bits to false.
+     */
+    constexpr StaticBitArray &reset() {
+        words.fill(0);
+        return *this;
+    }
+
+    /*!
+     * Set the `len` bits starting at `pos` to `val`.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     * @param val The value to set the bits to. Defaults to true.
+     */
+    constexpr StaticBitArray &set_range(size_t pos, size_t len,
+                                        bool val = true) {
+        for_range(pos, len, [&](size_t i, uint64_t mask) {
+            words[i] = val ? words[i] | mask : words[i] & ~mask;
+        });
+        return *this;
+    }
+
+    /*!
+     * Reset the `len` bits starting at `pos` to false.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    constexpr StaticBitArray &reset_range(size_t pos, size_t len) {
+        return set_range(pos, len, false);
+    }
+
+    /*!
+     * Invert the `len` bits starting at `pos`.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    constexpr StaticBitArray &flip_range(size_t pos, size_t len) {
+        for_range(pos, len,
+                  [&](size_t i, uint64_t mask) { words[i] ^= mask; });
+        return *this;
+    }
+
+    /*!
+     * Returns true if any of the bits are set.
+     */
+    constexpr bool any() const {
+        for (size_t i = 0; i < num_words_; i++) {
+            if (words[i] != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*!
+     * Returns true if none of the bits are set.
+     */
+    constexpr bool none() const { return !any(); }
+
+    /*!
+     * Returns true if any of the `len` bits starting at `pos` are set.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    constexpr bool any_range(size_t pos, size_t len) const {
+        bool found = false;
+        for_range(pos, len, [&](size_t i, uint64_t mask) {
+            found |= (words[i] & mask) != 0;
+        });
+        return found;
+    }
+
+    /*!
+     * Returns true if none of the `len` bits starting at `pos` are set.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    constexpr bool none_range(size_t pos, size_t len) const {
+        return !any_range(pos, len);
+    }
+
+    /*!
+     * Returns the number of bits that are set.
+     */
+    constexpr size_t count() const {
+        size_t cnt = 0;
+        for (size_t i = 0; i < num_words_; i++) {
+            cnt += std::popcount(words[i]);
+        }
+        return cnt;
+    }
+
+    /*!
+     * Returns the number of bits that are set among the `len` bits starting
+     * at `pos`.
+     * @param pos The index of the first bit of the range.
+     * @param len The number of bits in the range.
+     */
+    constexpr size_t count_range(size_t pos, size_t len) const {
+        size_t cnt = 0;
+        for_range(pos, len, [&](size_t i, uint64_t mask) {
+            cnt += std::popcount(words[i] & mask);
+        });
+        return cnt;
+    }
+
+    /*!
+     * Returns the value of the bit at `i`.
+     * @param i The index of the bit to get.
+     */
+    constexpr bool operator[](size_t i) const {
+        return (words[i / word_bits] >> (i % word_bits)) & 1;
+    }
+
+    /*!
+     * Returns the number of bits in the array.
+     */
+    static constexpr size_t size() { return N; }
+
+    /*!
+     * Returns true if the array has no bits.
+     */
+    static constexpr bool empty() { return N == 0; }
+
+    /*!
+     * Returns the index of the first set bit, or `npos` if there is none.
+     */
+    constexpr size_t find_first() const {
+        for (size_t i = 0; i < num_words_; i++) {
+            if (words[i] != 0) {
+                return i * word_bits + std::countr_zero(words[i]);
+            }
+        }
+        return npos;
+    }
+
+    /*!
+     * Returns the index of the first set bit after `pos`, or `npos` if there
+     * is none.
+     * @param pos The index to search after.
+     */
+    constexpr size_t find_next(size_t pos) const {
+        if (pos >= N || pos + 1 >= N) {
+            return npos;
+        }
+        pos++;
+        size_t i = pos / word_bits;
+        uint64_t word = words[i] & (~uint64_t{0} << (pos % word_bits));
+        while (word == 0) {
+            if (++i == num_words_) {
+                return npos;
+            }
+            word = words[i];
+        }
+        return i * word_bits + std::countr_zero(word);
+    }
+
+    /*!
+     * Returns the index of the last set bit, or `npos` if there is none.
+     */
+    constexpr size_t find_last() const {
+        for (size_t i = num_words_; i > 0; i--) {
+            if (words[i - 1] != 0) {
+                return i * word_bits - 1 - std::countl_zero(words[i - 1]);
+            }
+        }
+        return npos;
+    }
+
+    /*!
+     * Returns a pointer to the words of the array.
+     */
+    constexpr const uint64_t *data() const { return words.data(); }
+
+    /*!
+     * Returns a pointer to the words of the array. Callers must leave the bits
+     * past `size()` in the last word zero.
+     */
+    constexpr uint64_t *data() { return words.data(); }
+
+    /*!
+     * Returns the number of 64-bit words behind `data()`.
+     */
+    static constexpr size_t num_words() { return num_words_; }
+
+    /*!
+     * Returns a string of '0' and '1' with the last bit first.
+     */
+    constexpr std::string to_string() const {
+        std::string result(N, '0');
+        for (size_t i = 0; i < N; i++) {
+            if ((*this)[i]) {
+                result[N - 1 - i] = '1';
+            }
+        }
+        return result;
+    }
+
+    /*!
+     * AND the bits in `a` and `b`.
+     */
+    friend constexpr StaticBitArray operator&(const StaticBitArray &a,
+                                              const StaticBitArray &b) {
+        StaticBitArray res = a;
+        return res &= b;
+    }
+
+    /*!
+     * OR the bits in `a` and `b`.
+     */
+    friend constexpr StaticBitArray operator|(const StaticBitArray &a,
+                                              const StaticBitArray &b) {
+        StaticBitArray res = a;
+        return res |= b;
+    }
+
+    /*!
+     * XOR the bits in `a` and `b`.
+     */
+    friend constexpr StaticBitArray operator^(const StaticBitArray &a,
+                                              const StaticBitArray &b) {
+        StaticBitArray res = a;
+        return res ^= b;
+    }
+
+    /*!
+     * Invert the bits in `a`.
+     */
+    friend constexpr StaticBitArray operator~(const StaticBitArray &a) {
+        StaticBitArray res;
+        for (size_t i = 0; i < num_words_; i++) {
+            res.words[i] = ~a.words[i];
+        }
+        res.clear_unused_bits();
+        return res;
+    }
+
+    /*!
+     * Compare two StaticBitArrays for equality.
+     */
+    friend constexpr bool operator==(const StaticBitArray &a,
+                                     const StaticBitArray &b) {
+        return a.words == b.words;
+    }
+
+    /*!
+     * Compare two StaticBitArrays for inequality.
+     */
+    friend constexpr bool operator!=(const StaticBitArray &a,
+                                     const StaticBitArray &b) {
+        return !(a == b);
+    }
+
+private:
+    static constexpr size_t word_bits = bit_expr::word_bits;
+    static constexpr size_t num_words_ = (N + word_bits - 1) / word_bits;
+
+    /*!
+     * Pass every word covering the `len` bits starting at `pos` to
+     * `visit(index, mask)` with a mask of the bits in the range.
+     */
+    template <class Visit>
+    static constexpr void for_range(size_t pos, size_t len, Visit visit) {
+        if (pos > N || len > N - pos) {
+            throw std::invalid_argument("Error: bit range out of range");
+        }
+        if (len == 0) {
+            return;
+        }
+        size_t first = pos / word_bits;
+        size_t last = (pos + len - 1) / word_bits;
+        for (size_t i = first; i <= last; i++) {
+            uint64_t mask = ~uint64_t{0};
+            if (i == first) {
+                mask &= ~uint64_t{0} << (pos % word_bits);
+            }
+            if (i == last && (pos + len) % word_bits != 0) {
+                mask &= (uint64_t{1} << ((pos + len) % word_bits)) - 1;
+            }
+            visit(i, mask);
+        }
+    }
+
+    constexpr void clear_unused_bits() {
+        if constexpr (N % word_bits != 0) {
+            words[num_words_ - 1] &= (uint64_t{1} << (N % word_bits)) - 1;
+        }
+    }
+
+    std::array<uint64_t, num_words_> words{};
+};
+
+template <size_t N>
+inline constexpr bool bit_expr::is_leaf<StaticBitArray<N>> = true;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * A fixed set of worker threads for fork-join loops.
+ *
+ * `run(n, task)` calls `task(i)` for every `i` below `n` on the workers and on
+ * the calling thread, and returns once all the calls have finished. Tasks are
+ * handed out one at a time, so uneven tasks balance themselves. Calls to
+ * `run` from several threads are serialized; a task must not call `run` on
+ * the same pool.
+ */
+class ThreadPool {
+public:
+    /*!
+     * Start a pool that runs tasks on `threads` threads, counting the caller
+     * of `run`.
+     * @param threads The number of threads. 0 means one per hardware thread.
+     */
+    explicit ThreadPool(size_t threads = 0);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    /*!
+     * Call `task(i)` for every `i` in [0, `n`) and wait for all of them.
+     * @param n The number of tasks.
+     * @param task The function to call.
+     */
+    void run(size_t n, const std::function<void(size_t)> &task);
+
+    /*!
+     * Returns the number of threads that run tasks, counting the caller.
+     */
+    size_t size() const;
+
+private:
+    void work();
+    void drain(const std::function<void(size_t)> &task, size_t n);
+
+    std::vector<std::thread> workers{};
+    std::mutex run_mutex{};
+    std::mutex mutex{};
+    std::condition_variable wake{};
+    std::condition_variable done{};
+    // The current job, guarded by `mutex`. `next` hands out its tasks.
+    const std::function<void(size_t)> *task{};
+    size_t num_tasks{};
+    std::atomic<size_t> next{};
+    uint64_t generation{};
+    size_t active{};
+    bool stop{};
+};
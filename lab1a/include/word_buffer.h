@@ -0,0 +1,119 @@
+#pragma once
+
+#include "bit_cow.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * The growable array of 64-bit words behind a BitArray, in a block that
+ * copies may share while `bit_cow::enabled()`.
+ *
+ * Members that change the size give the buffer a private block before they
+ * write. The element accessors do not, so that word loops carry no checks:
+ * call `detach()` before writing through them.
+ */
+class WordBuffer {
+public:
+    WordBuffer() = default;
+
+    /*!
+     * Construct a buffer of `n` zero words.
+     * @param n The number of words.
+     */
+    explicit WordBuffer(size_t n);
+
+    /*!
+     * Share the block of `b` in copy-on-write mode, copy its words
+     * otherwise.
+     * @param b The buffer to copy from.
+     */
+    WordBuffer(const WordBuffer &b);
+
+    /*!
+     * Take the block of `b`, leaving `b` empty.
+     * @param b The buffer to move from.
+     */
+    WordBuffer(WordBuffer &&b) noexcept;
+
+    WordBuffer &operator=(const WordBuffer &b);
+    WordBuffer &operator=(WordBuffer &&b) noexcept;
+    ~WordBuffer();
+
+    /*!
+     * Swap the contents of this buffer with `b`.
+     * @param b The buffer to swap with.
+     */
+    void swap(WordBuffer &b) noexcept;
+
+    size_t size() const { return num_words; }
+    bool empty() const { return num_words == 0; }
+    size_t capacity() const { return capacity_words; }
+
+    const uint64_t *data() const { return words; }
+    uint64_t *data() { return words; }
+    const uint64_t *begin() const { return words; }
+    uint64_t *begin() { return words; }
+    const uint64_t *end() const { return words + num_words; }
+    uint64_t *end() { return words + num_words; }
+
+    const uint64_t &operator[](size_t i) const { return words[i]; }
+    uint64_t &operator[](size_t i) { return words[i]; }
+    const uint64_t &front() const { return words[0]; }
+    uint64_t &front() { return words[0]; }
+    const uint64_t &back() const { return words[num_words - 1]; }
+    uint64_t &back() { return words[num_words - 1]; }
+
+    /*!
+     * Give the buffer a block of its own if it shares one.
+     */
+    void detach() {
+        if (words != nullptr && bit_cow::shared(words)) {
+            reallocate(capacity_words);
+        }
+    }
+
+    /*!
+     * Remove all words. A shared block is dropped, an own one kept.
+     */
+    void clear();
+
+    /*!
+     * Resize the buffer to `n` words, setting new words to `value`.
+     * @param n The new number of words.
+     * @param value The value of the new words. Defaults to 0.
+     */
+    void resize(size_t n, uint64_t value = 0);
+
+    /*!
+     * Make room for at least `n` words.
+     * @param n The number of words to make room for.
+     */
+    void reserve(size_t n);
+
+    /*!
+     * Free the room past `size()` words.
+     */
+    void shrink_to_fit();
+
+    /*!
+     * Append the word `w`.
+     * @param w The word to append.
+     */
+    void push_back(uint64_t w);
+
+    /*!
+     * Remove the last word.
+     */
+    void pop_back() { num_words--; }
+
+private:
+    /*!
+     * Move the first words to a new, unshared block of `new_capacity` words.
+     */
+    void reallocate(size_t new_capacity);
+
+    uint64_t *words{};
+    size_t num_words{};
+    size_t capacity_words{};
+};
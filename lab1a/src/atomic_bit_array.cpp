@@ -0,0 +1,87 @@
+#include "atomic_bit_array.h"
+
+#include <bit>
+#include <utility>
+
+namespace {
+
+size_t word_count(size_t num_bits) { return (num_bits + 63) / 64; }
+
+} // namespace
+
+AtomicBitArray::AtomicBitArray(size_t num_bits)
+    : bits_size(num_bits),
+      words(std::make_unique<std::atomic<uint64_t>[]>(word_count(num_bits))) {
+}
+
+AtomicBitArray::AtomicBitArray(const BitArray &bits)
+    : AtomicBitArray(bits.size()) {
+    for (size_t i = 0; i < bits.num_words(); i++) {
+        words[i].store(bits.data()[i], std::memory_order_relaxed);
+    }
+}
+
+AtomicBitArray::AtomicBitArray(AtomicBitArray &&b) noexcept
+    : bits_size(std::exchange(b.bits_size, 0)), words(std::move(b.words)) {}
+
+AtomicBitArray &AtomicBitArray::operator=(AtomicBitArray &&b) noexcept {
+    if (this != &b) {
+        bits_size = std::exchange(b.bits_size, 0);
+        words = std::move(b.words);
+    }
+    return *this;
+}
+
+uint64_t AtomicBitArray::fetch_or(size_t i, uint64_t mask,
+                                  std::memory_order order) {
+    if (i >= num_words()) {
+        throw std::invalid_argument("Error: word index out of range");
+    }
+    // Keep the bits past size() clear, as in BitArray.
+    if (i == num_words() - 1 && bits_size % 64 != 0) {
+        mask &= (uint64_t{1} << (bits_size % 64)) - 1;
+    }
+    return words[i].fetch_or(mask, order);
+}
+
+uint64_t AtomicBitArray::fetch_and(size_t i, uint64_t mask,
+                                   std::memory_order order) {
+    if (i >= num_words()) {
+        throw std::invalid_argument("Error: word index out of range");
+    }
+    return words[i].fetch_and(mask, order);
+}
+
+uint64_t AtomicBitArray::load_word(size_t i, std::memory_order order) const {
+    if (i >= num_words()) {
+        throw std::invalid_argument("Error: word index out of range");
+    }
+    return words[i].load(order);
+}
+
+size_t AtomicBitArray::count() const {
+    size_t cnt = 0;
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        cnt += std::popcount(words[i].load(std::memory_order_relaxed));
+    }
+    return cnt;
+}
+
+void AtomicBitArray::reset() {
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t AtomicBitArray::size() const { return bits_size; }
+
+size_t AtomicBitArray::num_words() const { return word_count(bits_size); }
+
+BitArray AtomicBitArray::snapshot() const {
+    BitArray res(bits_size);
+    uint64_t *dst = res.data();
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        dst[i] = words[i].load(std::memory_order_acquire);
+    }
+    return res;
+}
@@ -0,0 +1,178 @@
+#include "bit_alloc.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BIT_ALLOC_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace bit_alloc {
+namespace {
+
+void *aligned_allocate(size_t bytes) {
+    return ::operator new(bytes, std::align_val_t{alignment});
+}
+
+void aligned_deallocate(void *p, size_t) {
+    ::operator delete(p, std::align_val_t{alignment});
+}
+
+constexpr Allocator aligned_allocator{"aligned", aligned_allocate,
+                                      aligned_deallocate};
+
+#ifdef BIT_ALLOC_MMAP
+
+size_t small_page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// A block of whole huge pages and at most `alignment` bytes more, such as a
+// huge page array behind a bit_cow header, starts that many bytes before a
+// huge page boundary, and the bytes in front get a small page of their own
+// instead of a whole extra huge page.
+bool has_head(size_t bytes) {
+    size_t rest = bytes % huge_page_size;
+    return rest != 0 && rest <= alignment;
+}
+
+size_t head_size(size_t bytes) {
+    return has_head(bytes) ? small_page_size() : 0;
+}
+
+// The huge page part of the mapping of a block
+size_t map_size(size_t bytes) {
+    if (has_head(bytes)) {
+        return bytes / huge_page_size * huge_page_size;
+    }
+    return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+// The block within a mapping whose huge pages start at `first`
+void *block_start(void *first, size_t bytes) {
+    return static_cast<char *>(first) - (has_head(bytes) ? alignment : 0);
+}
+
+/*!
+ * Map `head` bytes of small pages followed by `size` bytes starting on a
+ * huge page boundary, which plain mmap does not promise, by mapping one huge
+ * page more and unmapping the ends. Returns the huge page boundary.
+ */
+void *map_aligned(size_t head, size_t size) {
+    size_t padded = head + size + huge_page_size;
+    void *p = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    auto start = reinterpret_cast<uintptr_t>(p);
+    uintptr_t first = (start + head + huge_page_size - 1) / huge_page_size *
+                      huge_page_size;
+    size_t lead = first - head - start;
+    if (lead != 0) {
+        munmap(p, lead);
+    }
+    munmap(reinterpret_cast<void *>(first + size),
+           padded - lead - head - size);
+    return reinterpret_cast<void *>(first);
+}
+
+void *transparent_allocate(size_t bytes) {
+    if (bytes < huge_page_size) {
+        return aligned_allocate(bytes);
+    }
+    size_t size = map_size(bytes);
+    void *first = map_aligned(head_size(bytes), size);
+#ifdef MADV_HUGEPAGE
+    // Only a hint: with transparent huge pages off, the mapping keeps its
+    // small pages.
+    madvise(first, size, MADV_HUGEPAGE);
+#endif
+    return block_start(first, bytes);
+}
+
+void *huge_allocate(size_t bytes) {
+    if (bytes < huge_page_size) {
+        return aligned_allocate(bytes);
+    }
+#ifdef MAP_HUGETLB
+    size_t size = map_size(bytes);
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        size_t head = head_size(bytes);
+        if (head == 0) {
+            return p;
+        }
+#ifdef MAP_FIXED_NOREPLACE
+        // The head must sit right before the huge pages; if something is
+        // mapped there already, map the block the transparent way instead
+        void *want = static_cast<char *>(p) - head;
+        void *q = mmap(want, head, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1,
+                       0);
+        if (q == want) {
+            return block_start(p, bytes);
+        }
+        // Kernels before 4.17 take the address as a hint only
+        if (q != MAP_FAILED) {
+            munmap(q, head);
+        }
+#endif
+        munmap(p, size);
+    }
+#endif
+    return transparent_allocate(bytes);
+}
+
+// Both huge page allocators map every large block, so one function frees
+// them whichever kind of pages the mapping got. The head and the huge pages
+// are unmapped apart, as a range over both kinds of pages may not be.
+void map_deallocate(void *p, size_t bytes) {
+    if (bytes < huge_page_size) {
+        aligned_deallocate(p, bytes);
+        return;
+    }
+    char *first = static_cast<char *>(p) + (has_head(bytes) ? alignment : 0);
+    size_t head = head_size(bytes);
+    if (head != 0) {
+        munmap(first - head, head);
+    }
+    munmap(first, map_size(bytes));
+}
+
+constexpr Allocator transparent_allocator{
+    "transparent_huge_pages", transparent_allocate, map_deallocate};
+constexpr Allocator huge_allocator{"huge_pages", huge_allocate,
+                                   map_deallocate};
+
+#else
+
+constexpr Allocator transparent_allocator{
+    "transparent_huge_pages", aligned_allocate, aligned_deallocate};
+constexpr Allocator huge_allocator{"huge_pages", aligned_allocate,
+                                   aligned_deallocate};
+
+#endif // BIT_ALLOC_MMAP
+
+std::atomic<const Allocator *> current{&aligned_allocator};
+
+} // namespace
+
+const Allocator &aligned() { return aligned_allocator; }
+
+const Allocator &transparent_huge_pages() { return transparent_allocator; }
+
+const Allocator &huge_pages() { return huge_allocator; }
+
+void use(const Allocator &allocator) {
+    current.store(&allocator, std::memory_order_release);
+}
+
+const Allocator &active() { return *current.load(std::memory_order_acquire); }
+
+} // namespace bit_alloc
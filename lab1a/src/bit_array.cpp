@@ -1,83 +1,218 @@
 #include "bit_array.h"
+#include "bit_kernels.h"
+#include "bit_parallel.h"
+#include "bit_text.h"
 
 #include <algorithm>
-#include <limits>
-#include <numeric>
+#include <atomic>
 #include <stdexcept>
+#include <utility>
 
-BitArray::BitArray(size_t num_bits, uint64_t value) {
-    resize(num_bits);
-    for (size_t i = 0;
-         i < std::numeric_limits<decltype(value)>::digits && i < num_bits;
-         i++) {
-        bits[i] = value & 1;
-        value >>= 1;
+namespace {
+
+/*!
+ * Returns a mask of the bits that are in use in the last word of an array of
+ * `num_bits` bits.
+ */
+constexpr uint64_t tail_mask(size_t num_bits) {
+    size_t used = num_bits % std::numeric_limits<uint64_t>::digits;
+    return used == 0 ? ~uint64_t{0} : (uint64_t{1} << used) - 1;
+}
+
+/*!
+ * Visit the words covering the `len` bits starting at `pos`. The first and
+ * last words are passed to `partial(index, mask)` with a mask of the bits in
+ * the range. The words in between are passed to `full(first, last)` as a
+ * half-open index range.
+ */
+template <class Partial, class Full>
+void for_range(size_t pos, size_t len, Partial partial, Full full) {
+    if (len == 0) {
+        return;
+    }
+    constexpr size_t word_bits = std::numeric_limits<uint64_t>::digits;
+    size_t first = pos / word_bits;
+    size_t last = (pos + len - 1) / word_bits;
+    uint64_t head = ~uint64_t{0} << (pos % word_bits);
+    uint64_t tail = tail_mask(pos + len);
+    if (first == last) {
+        partial(first, head & tail);
+        return;
     }
+    partial(first, head);
+    full(first + 1, last);
+    partial(last, tail);
 }
 
-BitArray::BitArray(const BitArray &b) : bits(b.bits) {}
+} // namespace
+
+BitArray::BitArray(size_t num_bits, uint64_t value)
+    : bits_size(num_bits), words(word_count(num_bits)) {
+    if (!words.empty()) {
+        words.front() = value;
+        clear_unused_bits();
+    }
+}
 
-void BitArray::swap(BitArray &b) { std::swap(bits, b.bits); }
+BitArray::BitArray(const BitArray &b)
+    : bits_size(b.bits_size), words(b.words) {}
+
+BitArray::BitArray(BitArray &&b) noexcept
+    : bits_size(std::exchange(b.bits_size, 0)), words(std::move(b.words)) {
+    b.words.clear();
+}
+
+void BitArray::swap(BitArray &b) {
+    std::swap(bits_size, b.bits_size);
+    std::swap(words, b.words);
+}
 
 BitArray &BitArray::operator=(const BitArray &b) {
     if (this != &b) {
-        bits = b.bits;
+        bits_size = b.bits_size;
+        words = b.words;
+    }
+    return *this;
+}
+
+BitArray &BitArray::operator=(BitArray &&b) noexcept {
+    if (this != &b) {
+        bits_size = std::exchange(b.bits_size, 0);
+        words = std::move(b.words);
+        b.words.clear();
     }
     return *this;
 }
 
 void BitArray::resize(size_t num_bits, bool value) {
-    bits.resize(num_bits, value); // todo
+    words.detach();
+    if (value && num_bits > bits_size && bits_size % word_bits != 0) {
+        words.back() |= ~tail_mask(bits_size);
+    }
+    words.resize(word_count(num_bits), value ? ~word_type{0} : 0);
+    bits_size = num_bits;
+    clear_unused_bits();
+}
+
+void BitArray::reserve(size_t num_bits) {
+    words.reserve(word_count(num_bits));
 }
 
-void BitArray::clear() { bits.clear(); } // todo
+size_t BitArray::capacity() const { return words.capacity() * word_bits; }
 
-void BitArray::push_back(bool bit) { bits.push_back(bit); } // todo
+void BitArray::shrink_to_fit() { words.shrink_to_fit(); }
+
+void BitArray::clear() {
+    words.clear();
+    bits_size = 0;
+}
+
+void BitArray::push_back(bool bit) {
+    words.detach();
+    if (bits_size % word_bits == 0) {
+        words.push_back(0);
+    }
+    if (bit) {
+        words.back() |= word_type{1} << (bits_size % word_bits);
+    }
+    bits_size++;
+}
 
-void BitArray::pop_back() { bits.pop_back(); }
+void BitArray::pop_back() {
+    if (bits_size == 0) {
+        return;
+    }
+    words.detach();
+    bits_size--;
+    if (bits_size % word_bits == 0) {
+        words.pop_back();
+    } else {
+        clear_unused_bits();
+    }
+}
 
 BitArray &BitArray::operator&=(const BitArray &b) {
-    for (size_t i = 0; i < bits.size() && i < b.bits.size(); i++) {
-        if (!b.bits[i]) {
-            reset(i);
-        }
+    words.detach();
+    size_t min_bits = std::min(bits_size, b.bits_size);
+    size_t full_words = min_bits / word_bits;
+    bit_parallel::for_each(words.data(), full_words,
+                           [&](size_t first, size_t last) {
+                               for (size_t i = first; i < last; i++) {
+                                   words[i] &= b.words[i];
+                               }
+                           });
+    if (min_bits % word_bits != 0) {
+        // Bits past the end of the shorter array are left untouched.
+        words[full_words] &= b.words[full_words] | ~tail_mask(min_bits);
     }
     return *this;
 }
 
 BitArray &BitArray::operator|=(const BitArray &b) {
-    for (size_t i = 0; i < bits.size() && i < b.bits.size(); i++) {
-        if (b.bits[i]) {
-            set(i);
+    words.detach();
+    size_t n = word_count(std::min(bits_size, b.bits_size));
+    bit_parallel::for_each(words.data(), n, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            words[i] |= b.words[i];
         }
-    }
+    });
+    clear_unused_bits();
     return *this;
 }
 
 BitArray &BitArray::operator^=(const BitArray &b) {
-    for (size_t i = 0; i < bits.size() && i < b.bits.size(); i++) {
-        bits[i] = bits[i] != b.bits[i];
-    }
+    words.detach();
+    size_t n = word_count(std::min(bits_size, b.bits_size));
+    bit_parallel::for_each(words.data(), n, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            words[i] ^= b.words[i];
+        }
+    });
+    clear_unused_bits();
     return *this;
 }
 
 BitArray &BitArray::operator<<=(size_t n) {
-    if (n >= bits.size()) {
-        reset();
+    if (n >= bits_size) {
+        return reset();
+    }
+    words.detach();
+    size_t word_shift = n / word_bits;
+    size_t bit_shift = n % word_bits;
+    size_t last = words.size() - 1;
+    if (bit_shift == 0) {
+        std::copy_backward(words.begin(), words.end() - word_shift,
+                           words.end());
     } else {
-        std::rotate(bits.rbegin(), bits.rbegin() + n, bits.rend());
-        std::fill(bits.begin(), bits.begin() + n, false);
+        for (size_t i = last; i > word_shift; i--) {
+            words[i] = (words[i - word_shift] << bit_shift) |
+                       (words[i - word_shift - 1] >> (word_bits - bit_shift));
+        }
+        words[word_shift] = words[0] << bit_shift;
     }
+    std::fill(words.begin(), words.begin() + word_shift, 0);
+    clear_unused_bits();
     return *this;
 }
 
 BitArray &BitArray::operator>>=(size_t n) {
-    if (n >= bits.size()) {
-        reset();
+    if (n >= bits_size) {
+        return reset();
+    }
+    words.detach();
+    size_t word_shift = n / word_bits;
+    size_t bit_shift = n % word_bits;
+    size_t last = words.size() - 1 - word_shift;
+    if (bit_shift == 0) {
+        std::copy(words.begin() + word_shift, words.end(), words.begin());
     } else {
-        std::rotate(bits.begin(), bits.begin() + n, bits.end());
-        std::fill(bits.end() - n, bits.end(), false);
+        for (size_t i = 0; i < last; i++) {
+            words[i] = (words[i + word_shift] >> bit_shift) |
+                       (words[i + word_shift + 1] << (word_bits - bit_shift));
+        }
+        words[last] = words.back() >> bit_shift;
     }
+    std::fill(words.end() - word_shift, words.end(), 0);
     return *this;
 }
 
@@ -94,92 +229,256 @@ BitArray BitArray::operator>>(size_t n) const {
 }
 
 BitArray &BitArray::set(size_t n, bool val) {
-    if (n < 0 || n >= bits.size()) {
+    if (n >= bits_size) {
         throw std::invalid_argument("Error: bit index out of range");
     }
-    bits[n] = true;
+    words.detach();
+    word_type mask = word_type{1} << (n % word_bits);
+    if (val) {
+        words[n / word_bits] |= mask;
+    } else {
+        words[n / word_bits] &= ~mask;
+    }
     return *this;
 }
 
 BitArray &BitArray::set() {
-    for (size_t i = 0; i < bits.size(); i++) {
-        bits[i] = true;
-    }
+    words.detach();
+    std::fill(words.begin(), words.end(), ~word_type{0});
+    clear_unused_bits();
     return *this;
 }
 
 BitArray &BitArray::reset(size_t n) {
-    if (n < 0 || n >= bits.size()) {
+    if (n >= bits_size) {
         throw std::invalid_argument("Error: bit index out of range");
     }
-    bits[n] = false;
+    words.detach();
+    words[n / word_bits] &= ~(word_type{1} << (n % word_bits));
     return *this;
 }
 
 BitArray &BitArray::reset() {
-    for (size_t i = 0; i < bits.size(); i++) {
-        bits[i] = false;
-    }
+    words.detach();
+    std::fill(words.begin(), words.end(), 0);
+    return *this;
+}
+
+BitArray &BitArray::set_range(size_t pos, size_t len, bool val) {
+    check_range(pos, len);
+    words.detach();
+    word_type fill = val ? ~word_type{0} : 0;
+    for_range(
+        pos, len,
+        [&](size_t i, word_type mask) {
+            words[i] = (words[i] & ~mask) | (fill & mask);
+        },
+        [&](size_t first, size_t last) {
+            std::fill(words.begin() + first, words.begin() + last, fill);
+        });
+    return *this;
+}
+
+BitArray &BitArray::reset_range(size_t pos, size_t len) {
+    return set_range(pos, len, false);
+}
+
+BitArray &BitArray::flip_range(size_t pos, size_t len) {
+    check_range(pos, len);
+    words.detach();
+    for_range(
+        pos, len, [&](size_t i, word_type mask) { words[i] ^= mask; },
+        [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                words[i] = ~words[i];
+            }
+        });
     return *this;
 }
 
 bool BitArray::any() const {
-    return std::any_of(bits.begin(), bits.end(),
-                       [](bool bit) { return bit; }); // todo
+    // Once a chunk finds a set bit, the chunks that have not started yet
+    // skip their words.
+    std::atomic<bool> found{false};
+    auto any_words = [&](size_t first, size_t last) -> size_t {
+        if (found.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        bool res = std::any_of(words.begin() + first, words.begin() + last,
+                               [](word_type word) { return word != 0; });
+        if (res) {
+            found.store(true, std::memory_order_relaxed);
+        }
+        return res;
+    };
+    return bit_parallel::sum(words.data(), words.size(), any_words) != 0;
 }
 
-bool BitArray::none() const {
-    return std::none_of(bits.begin(), bits.end(), [](bool bit) { return bit; });
+bool BitArray::none() const { return !any(); }
+
+bool BitArray::any_range(size_t pos, size_t len) const {
+    check_range(pos, len);
+    bool found = false;
+    for_range(
+        pos, len,
+        [&](size_t i, word_type mask) { found |= (words[i] & mask) != 0; },
+        [&](size_t first, size_t last) {
+            found |= std::any_of(words.begin() + first, words.begin() + last,
+                                 [](word_type word) { return word != 0; });
+        });
+    return found;
 }
 
-BitArray BitArray::operator~() const {
-    BitArray res = *this;
-    auto invert = [](bool bit) { return !bit; };
-    std::transform(res.bits.begin(), res.bits.end(), res.bits.begin(), invert);
-    return res;
+bool BitArray::none_range(size_t pos, size_t len) const {
+    return !any_range(pos, len);
 }
 
 size_t BitArray::count() const {
-    return std::count(bits.begin(), bits.end(), true);
+    auto count_words = [&](size_t first, size_t last) {
+        return bit_kernels::active().count_bytes(
+            reinterpret_cast<const unsigned char *>(words.data() + first),
+            (last - first) * sizeof(word_type));
+    };
+    return bit_parallel::sum(words.data(), words.size(), count_words);
 }
 
-bool BitArray::operator[](size_t i) const { return bits[i]; }
+size_t BitArray::count_range(size_t pos, size_t len) const {
+    check_range(pos, len);
+    size_t cnt = 0;
+    for_range(
+        pos, len,
+        [&](size_t i, word_type mask) {
+            cnt += std::popcount(words[i] & mask);
+        },
+        [&](size_t first, size_t last) {
+            cnt += bit_kernels::active().count_bytes(
+                reinterpret_cast<const unsigned char *>(words.data() + first),
+                (last - first) * sizeof(word_type));
+        });
+    return cnt;
+}
 
-size_t BitArray::size() const { return bits.size(); }
+bool BitArray::operator[](size_t i) const {
+    return (words[i / word_bits] >> (i % word_bits)) & 1;
+}
 
-bool BitArray::empty() const { return bits.empty(); }
+size_t BitArray::size() const { return bits_size; }
 
-std::string BitArray::to_string() const {
-    auto fold = [](std::string a, bool b) {
-        return std::move(a) + std::to_string(b);
-    };
-    return std::accumulate(std::next(bits.rbegin()), bits.rend(),
-                           std::to_string(bits.back()), fold);
+bool BitArray::empty() const { return bits_size == 0; }
+
+const uint64_t *BitArray::data() const { return words.data(); }
+
+uint64_t *BitArray::data() {
+    words.detach();
+    return words.data();
 }
 
-bool operator==(const BitArray &a, const BitArray &b) {
-    if (a.bits.size() != b.bits.size()) {
-        return false;
+size_t BitArray::num_words() const { return words.size(); }
+
+size_t BitArray::find_first() const {
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i] != 0) {
+            return i * word_bits + std::countr_zero(words[i]);
+        }
     }
-    return std::equal(a.bits.begin(), a.bits.end(), b.bits.begin());
+    return npos;
 }
 
-bool operator!=(const BitArray &a, const BitArray &b) { return !(a == b); }
+size_t BitArray::find_next(size_t pos) const {
+    if (pos >= bits_size || pos + 1 >= bits_size) {
+        return npos;
+    }
+    pos++;
+    size_t i = pos / word_bits;
+    word_type word = words[i] & (~word_type{0} << (pos % word_bits));
+    while (word == 0) {
+        if (++i == words.size()) {
+            return npos;
+        }
+        word = words[i];
+    }
+    return i * word_bits + std::countr_zero(word);
+}
 
-BitArray operator&(const BitArray &a, const BitArray &b) {
-    BitArray res = a;
-    res &= b;
-    return res;
+size_t BitArray::find_last() const {
+    for (size_t i = words.size(); i > 0; i--) {
+        if (words[i - 1] != 0) {
+            return i * word_bits - 1 - std::countl_zero(words[i - 1]);
+        }
+    }
+    return npos;
 }
 
-BitArray operator|(const BitArray &a, const BitArray &b) {
-    BitArray res = a;
-    res |= b;
-    return res;
+BitArray::SetBitRange BitArray::set_bits() const {
+    return {words.data(), words.size()};
+}
+
+std::string BitArray::to_string() const {
+    std::string result(bits_size, '0');
+    bit_text::to_chars(reinterpret_cast<const unsigned char *>(words.data()),
+                       bits_size, result.data());
+    return result;
 }
 
-BitArray operator^(const BitArray &a, const BitArray &b) {
-    BitArray res = a;
-    res ^= b;
+BitArray BitArray::from_string(const std::string &s) {
+    BitArray res(s.size());
+    if (!bit_text::from_chars(s.data(), s.size(),
+                              reinterpret_cast<unsigned char *>(
+                                  res.words.data()))) {
+        throw std::invalid_argument("Error: invalid bit string");
+    }
     return res;
 }
+
+std::ostream &operator<<(std::ostream &os, const BitArray &b) {
+    return bit_text::write(
+        os, reinterpret_cast<const unsigned char *>(b.words.data()),
+        b.bits_size);
+}
+
+std::istream &operator>>(std::istream &is, BitArray &b) {
+    return bit_text::read(is, [&](size_t num_bits) {
+        b = BitArray(num_bits);
+        return reinterpret_cast<unsigned char *>(b.words.data());
+    });
+}
+
+size_t BitArray::word_count(size_t num_bits) {
+    return (num_bits + word_bits - 1) / word_bits;
+}
+
+void BitArray::check_range(size_t pos, size_t len) const {
+    if (pos > bits_size || len > bits_size - pos) {
+        throw std::invalid_argument("Error: bit range out of range");
+    }
+}
+
+void BitArray::clear_unused_bits() {
+    if (!words.empty()) {
+        words.back() &= tail_mask(bits_size);
+    }
+}
+
+bool operator==(const BitArray &a, const BitArray &b) {
+    if (a.bits_size != b.bits_size) {
+        return false;
+    }
+    // As in any(), chunks stop early once a difference was found.
+    std::atomic<bool> differ{false};
+    auto differ_words = [&](size_t first, size_t last) -> size_t {
+        if (differ.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        bool res = !std::equal(a.words.begin() + first,
+                               a.words.begin() + last,
+                               b.words.begin() + first);
+        if (res) {
+            differ.store(true, std::memory_order_relaxed);
+        }
+        return res;
+    };
+    return bit_parallel::sum(a.words.data(), a.words.size(), differ_words) ==
+           0;
+}
+
+bool operator!=(const BitArray &a, const BitArray &b) { return !(a == b); }
@@ -1,31 +1,123 @@
 #include "bit_array2.h"
+#include "bit_cow.h"
+#include "bit_kernels.h"
+#include "bit_text.h"
 
 #include <algorithm>
 #include <bitset>
 #include <cstring>
 #include <stdexcept>
+#include <utility>
 
-BitArray::BitArray() : bits_size(0), bits(nullptr) {}
+namespace {
 
-BitArray::~BitArray() { delete[] bits; }
+uint64_t load_word(const unsigned char *p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+void store_word(unsigned char *p, uint64_t word) {
+    std::memcpy(p, &word, sizeof(word));
+}
+
+/*!
+ * Move the bits of a `bytes`-long buffer `n` positions toward the high end in
+ * place, eight bytes at a time. Vacated low bits become zero.
+ */
+void shift_up(unsigned char *bits, size_t bytes, size_t n) {
+    size_t byte_shift = n / 8;
+    size_t bit_shift = n % 8;
+    size_t i = bytes;
+    // Walk down from the top so every source byte is read before it is
+    // overwritten.
+    while (i >= byte_shift + 8) {
+        i -= 8;
+        uint64_t word = load_word(bits + i - byte_shift) << bit_shift;
+        if (bit_shift != 0 && i > byte_shift) {
+            word |= bits[i - byte_shift - 1] >> (8 - bit_shift);
+        }
+        store_word(bits + i, word);
+    }
+    while (i > byte_shift) {
+        i--;
+        unsigned char byte = bits[i - byte_shift] << bit_shift;
+        if (bit_shift != 0 && i > byte_shift) {
+            byte |= bits[i - byte_shift - 1] >> (8 - bit_shift);
+        }
+        bits[i] = byte;
+    }
+    std::memset(bits, 0, byte_shift);
+}
+
+/*!
+ * Move the bits of a `bytes`-long buffer `n` positions toward the low end in
+ * place, eight bytes at a time. Vacated high bits become zero.
+ */
+void shift_down(unsigned char *bits, size_t bytes, size_t n) {
+    size_t byte_shift = n / 8;
+    size_t bit_shift = n % 8;
+    size_t i = 0;
+    for (; i + byte_shift + 8 <= bytes; i += 8) {
+        uint64_t word = load_word(bits + i + byte_shift) >> bit_shift;
+        if (bit_shift != 0 && i + byte_shift + 8 < bytes) {
+            word |= uint64_t{bits[i + byte_shift + 8]} << (64 - bit_shift);
+        }
+        store_word(bits + i, word);
+    }
+    for (; i + byte_shift < bytes; i++) {
+        unsigned char byte = bits[i + byte_shift] >> bit_shift;
+        if (bit_shift != 0 && i + byte_shift + 1 < bytes) {
+            byte |= bits[i + byte_shift + 1] << (8 - bit_shift);
+        }
+        bits[i] = byte;
+    }
+    std::memset(bits + bytes - byte_shift, 0, byte_shift);
+}
+
+} // namespace
+
+BitArray::BitArray() : bits_size(0), bits(inline_bits) {}
+
+BitArray::~BitArray() { release(); }
 
 BitArray::BitArray(size_t num_bits, uint64_t value) : bits_size(num_bits) {
     size_t bytes = (num_bits + 7) / 8;
-    bits = new unsigned char[bytes];
+    bits = allocate(bytes);
+    capacity_bytes = std::max(bytes, inline_bytes);
     std::memset(bits, 0, bytes); // Initialize all bits to 0
 
     std::memcpy(bits, &value, std::min(sizeof(value), bytes));
+    clear_unused_bits();
 }
 
 BitArray::BitArray(const BitArray &b) : bits_size(b.bits_size) {
+    if (bit_cow::enabled() && b.bits != b.inline_bits) {
+        bits = static_cast<unsigned char *>(bit_cow::share(b.bits));
+        capacity_bytes = b.capacity_bytes;
+        return;
+    }
     size_t bytes = (bits_size + 7) / 8;
-    bits = new unsigned char[bytes];
+    bits = allocate(bytes);
+    capacity_bytes = std::max(bytes, inline_bytes);
     std::memcpy(bits, b.bits, bytes);
 }
 
+BitArray::BitArray(BitArray &&b) noexcept : BitArray() { swap(b); }
+
 void BitArray::swap(BitArray &b) {
     std::swap(bits_size, b.bits_size);
+    std::swap(capacity_bytes, b.capacity_bytes);
     std::swap(bits, b.bits);
+    std::swap(inline_bits, b.inline_bits);
+    // An inline array must keep pointing at its own buffer, which now holds
+    // the swapped contents.
+    if (bits == b.inline_bits) {
+        bits = inline_bits;
+    }
+    if (b.bits == inline_bits) {
+        b.bits = b.inline_bits;
+    }
 }
 
 BitArray &BitArray::operator=(const BitArray &b) {
@@ -36,31 +128,52 @@ BitArray &BitArray::operator=(const BitArray &b) {
     return *this;
 }
 
+BitArray &BitArray::operator=(BitArray &&b) noexcept {
+    if (this != &b) {
+        BitArray temp(std::move(b));
+        swap(temp);
+    }
+    return *this;
+}
+
 void BitArray::resize(size_t num_bits, bool value) {
+    detach();
     size_t new_bytes = (num_bits + 7) / 8;
     size_t old_bytes = (bits_size + 7) / 8;
-    
-    bits_size = num_bits;
 
-    if (new_bytes == old_bytes)
-        return;
+    if (new_bytes > capacity_bytes) {
+        // Grow geometrically so that a run of push_back calls is linear.
+        reallocate(std::max(new_bytes, 2 * capacity_bytes));
+    }
+    if (new_bytes > old_bytes) {
+        std::memset(bits + old_bytes, value * 0xFF, new_bytes - old_bytes);
+    }
 
-    unsigned char *new_bits = new unsigned char[new_bytes];
-    std::memset(new_bits, value * 0xFF, new_bytes);
+    if (value && num_bits > bits_size && bits_size % 8 != 0) {
+        bits[bits_size / 8] |= 0xFF << (bits_size % 8);
+    }
+    bits_size = num_bits;
+    clear_unused_bits();
+}
 
-    if (bits) {
-        std::memcpy(new_bits, bits, std::min(old_bytes, new_bytes));
-        delete[] bits;
+void BitArray::reserve(size_t num_bits) {
+    size_t bytes = (num_bits + 7) / 8;
+    if (bytes > capacity_bytes) {
+        reallocate(bytes);
     }
-    bits = new_bits;
 }
 
-void BitArray::clear() {
-    delete[] bits;
-    bits = nullptr;
-    bits_size = 0;
+size_t BitArray::capacity() const { return capacity_bytes * 8; }
+
+void BitArray::shrink_to_fit() {
+    size_t bytes = (bits_size + 7) / 8;
+    if (capacity_bytes > std::max(bytes, inline_bytes)) {
+        reallocate(bytes);
+    }
 }
 
+void BitArray::clear() { bits_size = 0; }
+
 void BitArray::push_back(bool bit) {
     resize(bits_size + 1, false);
     set(bits_size - 1, bit);
@@ -73,33 +186,67 @@ void BitArray::pop_back() {
 }
 
 BitArray &BitArray::operator&=(const BitArray &b) {
+    detach();
     size_t min_bits = std::min(bits_size, b.bits_size);
-    for (size_t i = 0; i < (min_bits + 7) / 8; ++i) {
-        bits[i] &= b.bits[i];
+    size_t full_bytes = min_bits / 8;
+    bit_kernels::active().and_bytes(bits, b.bits, full_bytes);
+    if (min_bits % 8 != 0) {
+        // Bits past the end of the shorter array are left untouched.
+        bits[full_bytes] &= b.bits[full_bytes] | (0xFF << (min_bits % 8));
     }
     return *this;
 }
 
 BitArray &BitArray::operator|=(const BitArray &b) {
+    detach();
     size_t min_bits = std::min(bits_size, b.bits_size);
-    for (size_t i = 0; i < (min_bits + 7) / 8; ++i) {
-        bits[i] |= b.bits[i];
-    }
+    bit_kernels::active().or_bytes(bits, b.bits, (min_bits + 7) / 8);
+    clear_unused_bits();
     return *this;
 }
 
 BitArray &BitArray::operator^=(const BitArray &b) {
+    detach();
     size_t min_bits = std::min(bits_size, b.bits_size);
-    for (size_t i = 0; i < (min_bits + 7) / 8; ++i) {
-        bits[i] ^= b.bits[i];
+    bit_kernels::active().xor_bytes(bits, b.bits, (min_bits + 7) / 8);
+    clear_unused_bits();
+    return *this;
+}
+
+BitArray &BitArray::operator<<=(size_t n) {
+    if (n >= bits_size) {
+        return reset();
     }
+    detach();
+    shift_up(bits, (bits_size + 7) / 8, n);
+    clear_unused_bits();
     return *this;
 }
 
+BitArray &BitArray::operator>>=(size_t n) {
+    if (n >= bits_size) {
+        return reset();
+    }
+    detach();
+    shift_down(bits, (bits_size + 7) / 8, n);
+    return *this;
+}
+
+BitArray BitArray::operator<<(size_t n) const {
+    BitArray temp(*this);
+    return temp <<= n;
+}
+
+BitArray BitArray::operator>>(size_t n) const {
+    BitArray temp(*this);
+    return temp >>= n;
+}
+
 BitArray &BitArray::set(size_t n, bool val) {
     if (n >= bits_size) {
         throw std::out_of_range("Index out of range");
     }
+    detach();
     size_t byte_index = n / 8;
     size_t bit_index = n % 8;
     if (val) {
@@ -111,42 +258,28 @@ BitArray &BitArray::set(size_t n, bool val) {
 }
 
 BitArray &BitArray::set() {
+    detach();
     std::memset(bits, 0xFF, (bits_size + 7) / 8);
+    clear_unused_bits();
     return *this;
 }
 
 BitArray &BitArray::reset(size_t n) { return set(n, false); }
 
 BitArray &BitArray::reset() {
+    detach();
     std::memset(bits, 0, (bits_size + 7) / 8);
     return *this;
 }
 
 bool BitArray::any() const {
-    for (size_t i = 0; i < (bits_size + 7) / 8; ++i) {
-        if (bits[i] != 0)
-            return true;
-    }
-    return false;
+    return bit_kernels::active().any_bytes(bits, (bits_size + 7) / 8);
 }
 
 bool BitArray::none() const { return !any(); }
 
-BitArray BitArray::operator~() const {
-    BitArray temp(*this);
-    for (size_t i = 0; i < (bits_size + 7) / 8; ++i) {
-        temp.bits[i] = ~bits[i];
-    }
-    return temp;
-}
-
 size_t BitArray::count() const {
-    size_t cnt = 0;
-    for (size_t i = 0; i < bits_size; ++i) {
-        if ((*this)[i])
-            ++cnt;
-    }
-    return cnt;
+    return bit_kernels::active().count_bytes(bits, (bits_size + 7) / 8);
 }
 
 bool BitArray::operator[](size_t i) const {
@@ -162,32 +295,74 @@ size_t BitArray::size() const { return bits_size; }
 bool BitArray::empty() const { return bits_size == 0; }
 
 std::string BitArray::to_string() const {
-    std::string result;
-    for (size_t i = bits_size; i > 0; i--) {
-        result.push_back((*this)[i - 1] + '0');
-    }
+    std::string result(bits_size, '0');
+    bit_text::to_chars(bits, bits_size, result.data());
     return result;
 }
 
-bool operator==(const BitArray &a, const BitArray &b) {
-    if (a.bits_size != b.bits_size)
-        return false;
-    return std::memcmp(a.bits, b.bits, (a.bits_size + 7) / 8) == 0;
+BitArray BitArray::from_string(const std::string &s) {
+    BitArray res(s.size());
+    if (!bit_text::from_chars(s.data(), s.size(), res.bits)) {
+        throw std::invalid_argument("Error: invalid bit string");
+    }
+    return res;
 }
 
-bool operator!=(const BitArray &a, const BitArray &b) { return !(a == b); }
+std::ostream &operator<<(std::ostream &os, const BitArray &b) {
+    return bit_text::write(os, b.bits, b.bits_size);
+}
 
-BitArray operator&(const BitArray &b1, const BitArray &b2) {
-    BitArray temp(b1);
-    return temp &= b2;
+std::istream &operator>>(std::istream &is, BitArray &b) {
+    return bit_text::read(is, [&](size_t num_bits) {
+        b = BitArray(num_bits);
+        return b.bits;
+    });
 }
 
-BitArray operator|(const BitArray &b1, const BitArray &b2) {
-    BitArray temp(b1);
-    return temp |= b2;
+unsigned char *BitArray::allocate(size_t bytes) {
+    if (bytes <= inline_bytes) {
+        return inline_bits;
+    }
+    return static_cast<unsigned char *>(bit_cow::allocate(bytes));
 }
 
-BitArray operator^(const BitArray &b1, const BitArray &b2) {
-    BitArray temp(b1);
-    return temp ^= b2;
+void BitArray::reallocate(size_t new_capacity) {
+    unsigned char *new_bits = allocate(new_capacity);
+    if (new_bits != bits) {
+        std::memcpy(new_bits, bits,
+                    std::min((bits_size + 7) / 8, new_capacity));
+        release();
+        bits = new_bits;
+    }
+    capacity_bytes = std::max(new_capacity, inline_bytes);
+}
+
+void BitArray::release() {
+    if (bits != inline_bits) {
+        bit_cow::release(bits);
+    }
+}
+
+void BitArray::detach() {
+    if (bits != inline_bits && bit_cow::shared(bits)) {
+        unsigned char *own = allocate(capacity_bytes);
+        std::memcpy(own, bits, (bits_size + 7) / 8);
+        release();
+        bits = own;
+    }
 }
+
+void BitArray::clear_unused_bits() {
+    if (bits_size % 8 != 0) {
+        bits[bits_size / 8] &= (1 << (bits_size % 8)) - 1;
+    }
+}
+
+bool operator==(const BitArray &a, const BitArray &b) {
+    if (a.bits_size != b.bits_size)
+        return false;
+    return bit_kernels::active().equal_bytes(a.bits, b.bits,
+                                             (a.bits_size + 7) / 8);
+}
+
+bool operator!=(const BitArray &a, const BitArray &b) { return !(a == b); }
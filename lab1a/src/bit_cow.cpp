@@ -0,0 +1,38 @@
+#include "bit_cow.h"
+
+#include <new>
+
+namespace bit_cow {
+
+void enable() { detail::on.store(true, std::memory_order_relaxed); }
+
+void disable() { detail::on.store(false, std::memory_order_relaxed); }
+
+void *allocate(size_t bytes) {
+    const bit_alloc::Allocator &allocator = bit_alloc::active();
+    // The huge page allocators map a header in front of whole huge pages
+    // into a small page, so it costs no extra huge page.
+    void *p = allocator.allocate(sizeof(detail::Header) + bytes);
+    auto *h = new (p) detail::Header{1, bytes, &allocator};
+    return h + 1;
+}
+
+void *share(void *data) {
+    detail::header(data)->refs.fetch_add(1, std::memory_order_relaxed);
+    return data;
+}
+
+void release(void *data) {
+    if (data == nullptr) {
+        return;
+    }
+    detail::Header *h = detail::header(data);
+    if (h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        const bit_alloc::Allocator *allocator = h->allocator;
+        size_t bytes = sizeof(detail::Header) + h->bytes;
+        h->~Header();
+        allocator->deallocate(h, bytes);
+    }
+}
+
+} // namespace bit_cow
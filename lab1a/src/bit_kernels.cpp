@@ -0,0 +1,451 @@
+#include "bit_kernels.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||             \
+    defined(_M_IX86)
+#define BIT_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BIT_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BIT_KERNELS_TARGET(isa)
+#endif
+
+namespace bit_kernels {
+namespace {
+
+// Scalar kernels work on 64-bit words and finish the tail byte by byte. They
+// also handle the tails left over by the vector kernels.
+
+uint64_t load_word(const unsigned char *p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+void store_word(unsigned char *p, uint64_t word) {
+    std::memcpy(p, &word, sizeof(word));
+}
+
+void and_scalar(unsigned char *dst, const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store_word(dst + i, load_word(dst + i) & load_word(src + i));
+    }
+    for (; i < n; i++) {
+        dst[i] &= src[i];
+    }
+}
+
+void or_scalar(unsigned char *dst, const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store_word(dst + i, load_word(dst + i) | load_word(src + i));
+    }
+    for (; i < n; i++) {
+        dst[i] |= src[i];
+    }
+}
+
+void xor_scalar(unsigned char *dst, const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store_word(dst + i, load_word(dst + i) ^ load_word(src + i));
+    }
+    for (; i < n; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+void not_scalar(unsigned char *dst, const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store_word(dst + i, ~load_word(src + i));
+    }
+    for (; i < n; i++) {
+        dst[i] = ~src[i];
+    }
+}
+
+bool any_scalar(const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (load_word(src + i) != 0) {
+            return true;
+        }
+    }
+    for (; i < n; i++) {
+        if (src[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool equal_scalar(const unsigned char *a, const unsigned char *b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (load_word(a + i) != load_word(b + i)) {
+            return false;
+        }
+    }
+    for (; i < n; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t count_scalar(const unsigned char *src, size_t n) {
+    size_t cnt = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        cnt += std::popcount(load_word(src + i));
+    }
+    for (; i < n; i++) {
+        cnt += std::popcount(src[i]);
+    }
+    return cnt;
+}
+
+// Pair count kernels count the set bits of `a op b` word by word, with
+// `popcount` on the words and `std::popcount` on the tail bytes.
+#define BIT_KERNELS_PAIR_COUNT(name, attr, count_word, op)                     \
+    attr size_t name(const unsigned char *a, const unsigned char *b,           \
+                     size_t n) {                                               \
+        size_t cnt[4] = {};                                                    \
+        size_t i = 0;                                                          \
+        for (; i + 32 <= n; i += 32) {                                         \
+            for (size_t j = 0; j < 4; j++) {                                   \
+                cnt[j] += count_word(load_word(a + i + 8 * j) op               \
+                                   load_word(b + i + 8 * j));                  \
+            }                                                                  \
+        }                                                                      \
+        for (; i + 8 <= n; i += 8) {                                           \
+            cnt[0] += count_word(load_word(a + i) op load_word(b + i));        \
+        }                                                                      \
+        for (; i < n; i++) {                                                   \
+            cnt[0] += std::popcount(unsigned{a[i]} op unsigned{b[i]});         \
+        }                                                                      \
+        return cnt[0] + cnt[1] + cnt[2] + cnt[3];                              \
+    }
+
+#define BIT_KERNELS_AND_OR_COUNT(name, attr, count_word)                       \
+    attr size_t name(const unsigned char *a, const unsigned char *b,           \
+                     size_t n, size_t *or_count) {                             \
+        size_t and_cnt[2] = {};                                                \
+        size_t or_cnt[2] = {};                                                 \
+        size_t i = 0;                                                          \
+        for (; i + 16 <= n; i += 16) {                                         \
+            for (size_t j = 0; j < 2; j++) {                                   \
+                uint64_t x = load_word(a + i + 8 * j);                         \
+                uint64_t y = load_word(b + i + 8 * j);                         \
+                and_cnt[j] += count_word(x & y);                               \
+                or_cnt[j] += count_word(x | y);                                \
+            }                                                                  \
+        }                                                                      \
+        for (; i < n; i++) {                                                   \
+            unsigned x = a[i];                                                 \
+            unsigned y = b[i];                                                 \
+            and_cnt[0] += std::popcount(x & y);                                \
+            or_cnt[0] += std::popcount(x | y);                                 \
+        }                                                                      \
+        *or_count = or_cnt[0] + or_cnt[1];                                     \
+        return and_cnt[0] + and_cnt[1];                                        \
+    }
+
+BIT_KERNELS_PAIR_COUNT(and_count_scalar, , std::popcount, &)
+BIT_KERNELS_PAIR_COUNT(or_count_scalar, , std::popcount, |)
+BIT_KERNELS_PAIR_COUNT(xor_count_scalar, , std::popcount, ^)
+BIT_KERNELS_AND_OR_COUNT(and_or_count_scalar, , std::popcount)
+
+constexpr Kernels scalar_kernels{
+    "scalar",         and_scalar,          or_scalar,
+    xor_scalar,       not_scalar,          any_scalar,
+    equal_scalar,     count_scalar,        and_count_scalar,
+    or_count_scalar,  xor_count_scalar,    and_or_count_scalar};
+
+#ifdef BIT_KERNELS_X86
+
+// Vector kernels process one register per step and hand the remainder to the
+// scalar kernels.
+#define BIT_KERNELS_BINARY(name, isa, vec, load, store, op, tail)              \
+    BIT_KERNELS_TARGET(isa)                                                    \
+    void name(unsigned char *dst, const unsigned char *src, size_t n) {        \
+        size_t i = 0;                                                          \
+        for (; i + sizeof(vec) <= n; i += sizeof(vec)) {                       \
+            vec a = load(reinterpret_cast<const vec *>(dst + i));              \
+            vec b = load(reinterpret_cast<const vec *>(src + i));              \
+            store(reinterpret_cast<vec *>(dst + i), op(a, b));                 \
+        }                                                                      \
+        tail(dst + i, src + i, n - i);                                         \
+    }
+
+BIT_KERNELS_BINARY(and_sse2, "sse2", __m128i, _mm_loadu_si128,
+                   _mm_storeu_si128, _mm_and_si128, and_scalar)
+BIT_KERNELS_BINARY(or_sse2, "sse2", __m128i, _mm_loadu_si128, _mm_storeu_si128,
+                   _mm_or_si128, or_scalar)
+BIT_KERNELS_BINARY(xor_sse2, "sse2", __m128i, _mm_loadu_si128,
+                   _mm_storeu_si128, _mm_xor_si128, xor_scalar)
+
+BIT_KERNELS_TARGET("sse2")
+void not_sse2(unsigned char *dst, const unsigned char *src, size_t n) {
+    const __m128i ones = _mm_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + sizeof(__m128i) <= n; i += sizeof(__m128i)) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                         _mm_xor_si128(a, ones));
+    }
+    not_scalar(dst + i, src + i, n - i);
+}
+
+BIT_KERNELS_TARGET("sse2")
+bool any_sse2(const unsigned char *src, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + sizeof(__m128i) <= n; i += sizeof(__m128i)) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, zero)) != 0xFFFF) {
+            return true;
+        }
+    }
+    return any_scalar(src + i, n - i);
+}
+
+BIT_KERNELS_TARGET("sse2")
+bool equal_sse2(const unsigned char *a, const unsigned char *b, size_t n) {
+    size_t i = 0;
+    for (; i + sizeof(__m128i) <= n; i += sizeof(__m128i)) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) {
+            return false;
+        }
+    }
+    return equal_scalar(a + i, b + i, n - i);
+}
+
+BIT_KERNELS_BINARY(and_avx2, "avx2", __m256i, _mm256_loadu_si256,
+                   _mm256_storeu_si256, _mm256_and_si256, and_sse2)
+BIT_KERNELS_BINARY(or_avx2, "avx2", __m256i, _mm256_loadu_si256,
+                   _mm256_storeu_si256, _mm256_or_si256, or_sse2)
+BIT_KERNELS_BINARY(xor_avx2, "avx2", __m256i, _mm256_loadu_si256,
+                   _mm256_storeu_si256, _mm256_xor_si256, xor_sse2)
+
+BIT_KERNELS_TARGET("avx2")
+void not_avx2(unsigned char *dst, const unsigned char *src, size_t n) {
+    const __m256i ones = _mm256_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= n; i += sizeof(__m256i)) {
+        __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                            _mm256_xor_si256(a, ones));
+    }
+    not_sse2(dst + i, src + i, n - i);
+}
+
+BIT_KERNELS_TARGET("avx2")
+bool any_avx2(const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= n; i += sizeof(__m256i)) {
+        __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (!_mm256_testz_si256(a, a)) {
+            return true;
+        }
+    }
+    return any_sse2(src + i, n - i);
+}
+
+BIT_KERNELS_TARGET("avx2")
+bool equal_avx2(const unsigned char *a, const unsigned char *b, size_t n) {
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= n; i += sizeof(__m256i)) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i diff = _mm256_xor_si256(x, y);
+        if (!_mm256_testz_si256(diff, diff)) {
+            return false;
+        }
+    }
+    return equal_sse2(a + i, b + i, n - i);
+}
+
+BIT_KERNELS_BINARY(and_avx512, "avx512f", __m512i, _mm512_loadu_si512,
+                   _mm512_storeu_si512, _mm512_and_si512, and_avx2)
+BIT_KERNELS_BINARY(or_avx512, "avx512f", __m512i, _mm512_loadu_si512,
+                   _mm512_storeu_si512, _mm512_or_si512, or_avx2)
+BIT_KERNELS_BINARY(xor_avx512, "avx512f", __m512i, _mm512_loadu_si512,
+                   _mm512_storeu_si512, _mm512_xor_si512, xor_avx2)
+
+#undef BIT_KERNELS_BINARY
+
+BIT_KERNELS_TARGET("avx512f")
+void not_avx512(unsigned char *dst, const unsigned char *src, size_t n) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    size_t i = 0;
+    for (; i + sizeof(__m512i) <= n; i += sizeof(__m512i)) {
+        __m512i a = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i, _mm512_xor_si512(a, ones));
+    }
+    not_avx2(dst + i, src + i, n - i);
+}
+
+BIT_KERNELS_TARGET("avx512f")
+bool any_avx512(const unsigned char *src, size_t n) {
+    size_t i = 0;
+    for (; i + sizeof(__m512i) <= n; i += sizeof(__m512i)) {
+        __m512i a = _mm512_loadu_si512(src + i);
+        if (_mm512_test_epi64_mask(a, a) != 0) {
+            return true;
+        }
+    }
+    return any_avx2(src + i, n - i);
+}
+
+BIT_KERNELS_TARGET("avx512f")
+bool equal_avx512(const unsigned char *a, const unsigned char *b, size_t n) {
+    size_t i = 0;
+    for (; i + sizeof(__m512i) <= n; i += sizeof(__m512i)) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        if (_mm512_cmpneq_epi64_mask(x, y) != 0) {
+            return false;
+        }
+    }
+    return equal_avx2(a + i, b + i, n - i);
+}
+
+// Every CPU with AVX2 also has POPCNT, so the wider kernel sets count with the
+// hardware instruction. Four independent sums keep it from stalling on the
+// instruction latency.
+BIT_KERNELS_TARGET("popcnt")
+inline size_t popcnt_word(uint64_t word) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return static_cast<size_t>(_mm_popcnt_u64(word));
+#else
+    return _mm_popcnt_u32(static_cast<uint32_t>(word)) +
+           _mm_popcnt_u32(static_cast<uint32_t>(word >> 32));
+#endif
+}
+
+BIT_KERNELS_TARGET("popcnt")
+size_t count_popcnt(const unsigned char *src, size_t n) {
+    size_t cnt[4] = {};
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        for (size_t j = 0; j < 4; j++) {
+            cnt[j] += popcnt_word(load_word(src + i + 8 * j));
+        }
+    }
+    for (; i + 8 <= n; i += 8) {
+        cnt[0] += popcnt_word(load_word(src + i));
+    }
+    for (; i < n; i++) {
+        cnt[0] += std::popcount(src[i]);
+    }
+    return cnt[0] + cnt[1] + cnt[2] + cnt[3];
+}
+
+BIT_KERNELS_PAIR_COUNT(and_count_popcnt, BIT_KERNELS_TARGET("popcnt"),
+                       popcnt_word, &)
+BIT_KERNELS_PAIR_COUNT(or_count_popcnt, BIT_KERNELS_TARGET("popcnt"),
+                       popcnt_word, |)
+BIT_KERNELS_PAIR_COUNT(xor_count_popcnt, BIT_KERNELS_TARGET("popcnt"),
+                       popcnt_word, ^)
+BIT_KERNELS_AND_OR_COUNT(and_or_count_popcnt, BIT_KERNELS_TARGET("popcnt"),
+                         popcnt_word)
+
+constexpr Kernels sse2_kernels{
+    "sse2",           and_sse2,         or_sse2,
+    xor_sse2,         not_sse2,         any_sse2,
+    equal_sse2,       count_scalar,     and_count_scalar,
+    or_count_scalar,  xor_count_scalar, and_or_count_scalar};
+constexpr Kernels avx2_kernels{
+    "avx2",           and_avx2,         or_avx2,
+    xor_avx2,         not_avx2,         any_avx2,
+    equal_avx2,       count_popcnt,     and_count_popcnt,
+    or_count_popcnt,  xor_count_popcnt, and_or_count_popcnt};
+constexpr Kernels avx512_kernels{
+    "avx512",         and_avx512,       or_avx512,
+    xor_avx512,       not_avx512,       any_avx512,
+    equal_avx512,     count_popcnt,     and_count_popcnt,
+    or_count_popcnt,  xor_count_popcnt, and_or_count_popcnt};
+
+enum class Isa { sse2, avx2, avx512 };
+
+bool cpu_supports(Isa isa) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    switch (isa) {
+    case Isa::sse2:
+        return __builtin_cpu_supports("sse2");
+    case Isa::avx2:
+        return __builtin_cpu_supports("avx2");
+    case Isa::avx512:
+        return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#elif defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    int max_leaf = regs[0];
+    __cpuid(regs, 1);
+    if (isa == Isa::sse2) {
+        return (regs[3] & (1 << 26)) != 0;
+    }
+    // The OS must save the AVX (and for AVX-512, opmask and ZMM) state.
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    if (!osxsave || max_leaf < 7) {
+        return false;
+    }
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(regs, 7, 0);
+    if (isa == Isa::avx2) {
+        return (xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5)) != 0;
+    }
+    return (xcr0 & 0xE6) == 0xE6 && (regs[1] & (1 << 16)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // BIT_KERNELS_X86
+
+} // namespace
+
+std::vector<const Kernels *> supported() {
+    std::vector<const Kernels *> result{&scalar_kernels};
+#ifdef BIT_KERNELS_X86
+    if (cpu_supports(Isa::sse2)) {
+        result.push_back(&sse2_kernels);
+    }
+    if (cpu_supports(Isa::avx2)) {
+        result.push_back(&avx2_kernels);
+    }
+    if (cpu_supports(Isa::avx512)) {
+        result.push_back(&avx512_kernels);
+    }
+#endif
+    return result;
+}
+
+const Kernels &active() {
+    static const Kernels &kernels = *supported().back();
+    return kernels;
+}
+
+} // namespace bit_kernels
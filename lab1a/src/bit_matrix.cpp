@@ -0,0 +1,246 @@
+#include "bit_matrix.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+/*!
+ * Transpose the 64x64 bit block in `block` in place: bit `j` of word `i`
+ * swaps with bit `i` of word `j`. Each round swaps the off-diagonal
+ * quadrants of every `2j` by `2j` sub-block, `j` halving from 32 to 1, so the
+ * block moves in 6 rounds of 32 word operations instead of 4096 bit moves.
+ */
+void transpose_block(uint64_t *block) {
+    uint64_t mask = 0x00000000FFFFFFFF;
+    for (size_t j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((block[k] >> j) ^ block[k | j]) & mask;
+            block[k] ^= t << j;
+            block[k | j] ^= t;
+        }
+    }
+}
+
+} // namespace
+
+ConstBitColumn::ConstBitColumn(const uint64_t *words, size_t stride,
+                               size_t col, size_t rows)
+    : words(words + col / 64), stride(stride), shift(col % 64),
+      num_rows(rows) {}
+
+size_t ConstBitColumn::count() const {
+    size_t cnt = 0;
+    for (size_t i = 0; i < num_rows; i++) {
+        cnt += (*this)[i];
+    }
+    return cnt;
+}
+
+BitArray ConstBitColumn::to_bit_array() const {
+    BitArray res(num_rows);
+    uint64_t *dst = res.data();
+    for (size_t i = 0; i < num_rows; i++) {
+        dst[i / 64] |= uint64_t{(*this)[i]} << (i % 64);
+    }
+    return res;
+}
+
+BitColumn::BitColumn(uint64_t *words, size_t stride, size_t col, size_t rows)
+    : ConstBitColumn(words, stride, col, rows) {}
+
+const BitColumn &BitColumn::set(size_t n, bool val) const {
+    if (n >= num_rows) {
+        throw std::invalid_argument("Error: bit index out of range");
+    }
+    // The view only ever points into a mutable matrix.
+    uint64_t &word = const_cast<uint64_t &>(words[n * stride]);
+    word = (word & ~(uint64_t{1} << shift)) | (uint64_t{val} << shift);
+    return *this;
+}
+
+const BitColumn &BitColumn::reset(size_t n) const { return set(n, false); }
+
+const BitColumn &BitColumn::assign(const BitArray &src) const {
+    if (src.size() != num_rows) {
+        throw std::invalid_argument("Error: bit array sizes do not match");
+    }
+    for (size_t i = 0; i < num_rows; i++) {
+        set(i, src[i]);
+    }
+    return *this;
+}
+
+BitMatrix::BitMatrix(size_t rows, size_t cols)
+    : num_rows(rows), num_cols(cols), row_words((cols + 63) / 64),
+      bits(rows * row_words * 64) {}
+
+BitMatrix BitMatrix::identity(size_t n) {
+    BitMatrix res(n, n);
+    for (size_t i = 0; i < n; i++) {
+        res.set(i, i);
+    }
+    return res;
+}
+
+size_t BitMatrix::rows() const { return num_rows; }
+
+size_t BitMatrix::cols() const { return num_cols; }
+
+size_t BitMatrix::stride() const { return row_words; }
+
+BitMatrix &BitMatrix::set(size_t r, size_t c, bool val) {
+    check_row(r);
+    check_column(c);
+    bits.set(r * row_words * 64 + c, val);
+    return *this;
+}
+
+BitMatrix &BitMatrix::reset(size_t r, size_t c) { return set(r, c, false); }
+
+ConstBitSpan BitMatrix::row(size_t r) const {
+    check_row(r);
+    return {bits.data() + r * row_words, 0, num_cols};
+}
+
+BitSpan BitMatrix::row(size_t r) {
+    check_row(r);
+    return {bits.data() + r * row_words, 0, num_cols};
+}
+
+ConstBitColumn BitMatrix::column(size_t c) const {
+    check_column(c);
+    return {bits.data(), row_words, c, num_rows};
+}
+
+BitColumn BitMatrix::column(size_t c) {
+    check_column(c);
+    return {bits.data(), row_words, c, num_rows};
+}
+
+size_t BitMatrix::count() const { return bits.count(); }
+
+BitMatrix BitMatrix::transpose() const {
+    BitMatrix res(num_cols, num_rows);
+    if (bits.empty()) {
+        return res;
+    }
+    const uint64_t *src = bits.data();
+    uint64_t *dst = res.bits.data();
+    uint64_t block[64];
+    // Block (bi, bj) holds rows 64 * bi.. and word bj of each of them, and
+    // lands on rows 64 * bj.. and word bi of the result. Rows past the end
+    // read as zeros; the zero padding columns turn into rows that are
+    // dropped.
+    for (size_t bi = 0; bi < res.row_words; bi++) {
+        size_t first = 64 * bi;
+        size_t height = std::min<size_t>(64, num_rows - first);
+        for (size_t bj = 0; bj < row_words; bj++) {
+            for (size_t k = 0; k < 64; k++) {
+                block[k] = k < height ? src[(first + k) * row_words + bj] : 0;
+            }
+            transpose_block(block);
+            size_t width = std::min<size_t>(64, num_cols - 64 * bj);
+            for (size_t k = 0; k < width; k++) {
+                dst[(64 * bj + k) * res.row_words + bi] = block[k];
+            }
+        }
+    }
+    return res;
+}
+
+BitMatrix &BitMatrix::operator|=(const BitMatrix &m) {
+    if (num_rows != m.num_rows || num_cols != m.num_cols) {
+        throw std::invalid_argument("Error: matrix sizes do not match");
+    }
+    bits |= m.bits;
+    return *this;
+}
+
+BitMatrix operator*(const BitMatrix &a, const BitMatrix &b) {
+    if (a.num_cols != b.num_rows) {
+        throw std::invalid_argument("Error: matrix sizes do not match");
+    }
+    BitMatrix res(a.num_rows, b.num_cols);
+    if (res.bits.empty() || a.bits.empty()) {
+        return res;
+    }
+
+    // Row i of the product is the OR of the rows of `b` picked by the set
+    // bits of row i of `a`, which costs a row of `b` per bit of `a`. For a
+    // dense `a` it is cheaper to AND row i of `a` with each row of the
+    // transpose of `b` and stop at the first common bit: the popcounts give
+    // the densities and so how soon that bit is expected.
+    double bits_a = double(a.count());
+    double bits_b = double(b.count());
+    double row_cost = bits_a * double(b.row_words);
+    double density = bits_a / (double(a.num_rows) * double(a.num_cols)) *
+                     bits_b / (double(b.num_rows) * double(b.num_cols));
+    double hit = 1 - std::pow(1 - density, 64.0);
+    double probes = hit > 0 ? std::min(double(a.row_words), 1 / hit)
+                            : double(a.row_words);
+    double dot_cost = double(a.num_rows) * double(b.num_cols) * probes +
+                      double(b.num_rows) * double(b.row_words);
+
+    const uint64_t *src = a.bits.data();
+    uint64_t *dst = res.bits.data();
+    if (row_cost <= dot_cost) {
+        const uint64_t *rows_b = b.bits.data();
+        for (size_t i = 0; i < a.num_rows; i++) {
+            const uint64_t *row_a = src + i * a.row_words;
+            uint64_t *out = dst + i * res.row_words;
+            for (size_t w = 0; w < a.row_words; w++) {
+                for (uint64_t word = row_a[w]; word != 0; word &= word - 1) {
+                    size_t k = 64 * w + std::countr_zero(word);
+                    const uint64_t *row_b = rows_b + k * b.row_words;
+                    for (size_t v = 0; v < b.row_words; v++) {
+                        out[v] |= row_b[v];
+                    }
+                }
+            }
+        }
+        return res;
+    }
+
+    BitMatrix bt = b.transpose();
+    const uint64_t *cols_b = bt.bits.data();
+    for (size_t i = 0; i < a.num_rows; i++) {
+        const uint64_t *row_a = src + i * a.row_words;
+        uint64_t *out = dst + i * res.row_words;
+        for (size_t j = 0; j < b.num_cols; j++) {
+            const uint64_t *col_b = cols_b + j * bt.row_words;
+            for (size_t w = 0; w < a.row_words; w++) {
+                if ((row_a[w] & col_b[w]) != 0) {
+                    out[j / 64] |= uint64_t{1} << (j % 64);
+                    break;
+                }
+            }
+        }
+    }
+    return res;
+}
+
+bool operator==(const BitMatrix &a, const BitMatrix &b) {
+    return a.num_rows == b.num_rows && a.num_cols == b.num_cols &&
+           a.bits == b.bits;
+}
+
+bool operator!=(const BitMatrix &a, const BitMatrix &b) { return !(a == b); }
+
+const uint64_t *BitMatrix::data() const { return bits.data(); }
+
+uint64_t *BitMatrix::data() { return bits.data(); }
+
+void BitMatrix::check_row(size_t r) const {
+    if (r >= num_rows) {
+        throw std::invalid_argument("Error: bit index out of range");
+    }
+}
+
+void BitMatrix::check_column(size_t c) const {
+    if (c >= num_cols) {
+        throw std::invalid_argument("Error: bit index out of range");
+    }
+}
@@ -0,0 +1,111 @@
+#include "bit_metrics.h"
+#include "bit_kernels.h"
+#include "bit_parallel.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+
+using PairCount = size_t (*)(const unsigned char *, const unsigned char *,
+                             size_t);
+
+const unsigned char *bytes(const uint64_t *words) {
+    return reinterpret_cast<const unsigned char *>(words);
+}
+
+void check_sizes(const BitArray &a, const BitArray &b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Error: bit array sizes do not match");
+    }
+}
+
+size_t pair_count(const BitArray &a, const BitArray &b, PairCount kernel) {
+    check_sizes(a, b);
+    const uint64_t *x = a.data();
+    const uint64_t *y = b.data();
+    return bit_parallel::sum(x, a.num_words(), [&](size_t first, size_t last) {
+        return kernel(bytes(x + first), bytes(y + first),
+                      (last - first) * sizeof(uint64_t));
+    });
+}
+
+double jaccard_bytes(const unsigned char *a, const unsigned char *b,
+                     size_t n) {
+    size_t or_count = 0;
+    size_t and_count = bit_kernels::active().and_or_count_bytes(a, b, n,
+                                                                &or_count);
+    return or_count == 0 ? 1.0 : double(and_count) / double(or_count);
+}
+
+/*!
+ * Store `score(query, row, num_bytes)` for every row of `batch` in `out`.
+ */
+template <class T, class Score>
+void score_rows(const BitArray &query, const BitMatrix &batch,
+                std::span<T> out, Score score) {
+    if (query.size() != batch.cols()) {
+        throw std::invalid_argument("Error: bit array sizes do not match");
+    }
+    if (out.size() != batch.rows()) {
+        throw std::invalid_argument("Error: result size mismatch");
+    }
+    // The query has as many words as a row, both with zero padding.
+    const unsigned char *q = bytes(query.data());
+    size_t num_bytes = batch.stride() * sizeof(uint64_t);
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i] = score(q, bytes(batch.data() + i * batch.stride()), num_bytes);
+    }
+}
+
+} // namespace
+
+size_t hamming(const BitArray &a, const BitArray &b) {
+    return pair_count(a, b, bit_kernels::active().xor_count_bytes);
+}
+
+size_t intersect_count(const BitArray &a, const BitArray &b) {
+    return pair_count(a, b, bit_kernels::active().and_count_bytes);
+}
+
+size_t union_count(const BitArray &a, const BitArray &b) {
+    return pair_count(a, b, bit_kernels::active().or_count_bytes);
+}
+
+double jaccard(const BitArray &a, const BitArray &b) {
+    check_sizes(a, b);
+    return jaccard_bytes(bytes(a.data()), bytes(b.data()),
+                         a.num_words() * sizeof(uint64_t));
+}
+
+bool is_subset(const BitArray &a, const BitArray &b) {
+    check_sizes(a, b);
+    const uint64_t *x = a.data();
+    const uint64_t *y = b.data();
+    for (size_t i = 0, n = a.num_words(); i < n; i++) {
+        if ((x[i] & ~y[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void hamming_many(const BitArray &query, const BitMatrix &batch,
+                  std::span<size_t> out) {
+    score_rows(query, batch, out, bit_kernels::active().xor_count_bytes);
+}
+
+void intersect_count_many(const BitArray &query, const BitMatrix &batch,
+                          std::span<size_t> out) {
+    score_rows(query, batch, out, bit_kernels::active().and_count_bytes);
+}
+
+void union_count_many(const BitArray &query, const BitMatrix &batch,
+                      std::span<size_t> out) {
+    score_rows(query, batch, out, bit_kernels::active().or_count_bytes);
+}
+
+void jaccard_many(const BitArray &query, const BitMatrix &batch,
+                  std::span<double> out) {
+    score_rows(query, batch, out, jaccard_bytes);
+}
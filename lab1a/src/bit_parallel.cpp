@@ -0,0 +1,96 @@
+#include "bit_parallel.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bit_parallel {
+
+namespace {
+
+constexpr size_t line_words = 64 / sizeof(uint64_t);
+
+// Chunks per thread, so that a slow thread does not hold up the others.
+constexpr size_t chunks_per_thread = 4;
+
+std::unique_ptr<ThreadPool> pool;
+
+/*!
+ * Splits a word range into chunks whose boundaries fall on cache lines, so
+ * that no two threads write to the same line.
+ */
+class Chunks {
+public:
+    Chunks(const void *base, size_t num_words) : num_words(num_words) {
+        // The words before the first line boundary go to the first chunk.
+        auto address = reinterpret_cast<uintptr_t>(base);
+        size_t offset = address / sizeof(uint64_t) % line_words;
+        lead = std::min(num_words, (line_words - offset) % line_words);
+        size_t wanted = pool->size() * chunks_per_thread;
+        chunk_words = (num_words + wanted - 1) / wanted;
+        chunk_words = (chunk_words + line_words - 1) / line_words * line_words;
+        count = num_words == lead
+                    ? 1
+                    : (num_words - lead + chunk_words - 1) / chunk_words;
+    }
+
+    size_t first(size_t k) const {
+        return k == 0 ? 0 : lead + k * chunk_words;
+    }
+
+    size_t last(size_t k) const {
+        return std::min(num_words, lead + (k + 1) * chunk_words);
+    }
+
+    size_t count{};
+
+private:
+    size_t num_words;
+    size_t lead{};
+    size_t chunk_words{};
+};
+
+} // namespace
+
+void enable(const Options &options) {
+    pool = std::make_unique<ThreadPool>(options.threads);
+    detail::min_words.store(std::max<size_t>(options.min_words, 1),
+                            std::memory_order_relaxed);
+}
+
+void disable() {
+    detail::min_words.store(std::numeric_limits<size_t>::max(),
+                            std::memory_order_relaxed);
+    pool.reset();
+}
+
+bool enabled() { return pool != nullptr; }
+
+namespace detail {
+
+void for_each(const void *base, size_t num_words,
+              const std::function<void(size_t, size_t)> &body) {
+    Chunks chunks(base, num_words);
+    pool->run(chunks.count,
+              [&](size_t k) { body(chunks.first(k), chunks.last(k)); });
+}
+
+size_t sum(const void *base, size_t num_words,
+           const std::function<size_t(size_t, size_t)> &body) {
+    Chunks chunks(base, num_words);
+    std::vector<size_t> partial(chunks.count);
+    pool->run(chunks.count, [&](size_t k) {
+        partial[k] = body(chunks.first(k), chunks.last(k));
+    });
+    size_t total = 0;
+    for (size_t value : partial) {
+        total += value;
+    }
+    return total;
+}
+
+} // namespace detail
+
+} // namespace bit_parallel
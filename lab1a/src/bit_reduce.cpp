@@ -0,0 +1,138 @@
+#include "bit_reduce.h"
+#include "bit_parallel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// The words of the output built at a time: small enough that the block, and
+// the counters of `at_least_k`, stay in L1 while every input is read.
+constexpr size_t block_words = 256;
+
+size_t common_size(std::span<const BitArray *const> arrays) {
+    if (arrays.empty()) {
+        return 0;
+    }
+    size_t size = arrays[0]->size();
+    for (const BitArray *a : arrays) {
+        if (a->size() != size) {
+            throw std::invalid_argument("Error: bit array sizes do not match");
+        }
+    }
+    return size;
+}
+
+/*!
+ * Call `body(first, last)` on blocks of at most `block_words` words covering
+ * the `num_words` words at `base`, spread over threads in parallel mode.
+ */
+template <class Body>
+void for_each_block(const void *base, size_t num_words, Body body) {
+    bit_parallel::for_each(base, num_words, [&](size_t first, size_t last) {
+        for (size_t lo = first; lo < last; lo += block_words) {
+            body(lo, std::min(last, lo + block_words));
+        }
+    });
+}
+
+} // namespace
+
+BitArray and_all(std::span<const BitArray *const> arrays) {
+    BitArray res(common_size(arrays));
+    uint64_t *dst = res.data();
+    for_each_block(dst, res.num_words(), [&](size_t first, size_t last) {
+        std::copy(arrays[0]->data() + first, arrays[0]->data() + last,
+                  dst + first);
+        for (size_t j = 1; j < arrays.size(); j++) {
+            const uint64_t *src = arrays[j]->data();
+            uint64_t any = 0;
+            for (size_t i = first; i < last; i++) {
+                dst[i] &= src[i];
+                any |= dst[i];
+            }
+            if (any == 0) {
+                break;
+            }
+        }
+    });
+    return res;
+}
+
+BitArray or_all(std::span<const BitArray *const> arrays) {
+    BitArray res(common_size(arrays));
+    uint64_t *dst = res.data();
+    for_each_block(dst, res.num_words(), [&](size_t first, size_t last) {
+        for (const BitArray *a : arrays) {
+            const uint64_t *src = a->data();
+            for (size_t i = first; i < last; i++) {
+                dst[i] |= src[i];
+            }
+        }
+    });
+    return res;
+}
+
+BitArray at_least_k(std::span<const BitArray *const> arrays, size_t k) {
+    size_t size = common_size(arrays);
+    BitArray res(size);
+    if (k == 0) {
+        return res.set();
+    }
+    if (k > arrays.size()) {
+        return res;
+    }
+    if (k == 1) {
+        return or_all(arrays);
+    }
+    if (k == arrays.size()) {
+        return and_all(arrays);
+    }
+
+    uint64_t *dst = res.data();
+    // Bit b of word i of plane p is bit p of the number of inputs with bit b
+    // of word i set.
+    size_t num_planes = std::bit_width(arrays.size());
+    bit_parallel::for_each(dst, res.num_words(), [&](size_t lo, size_t hi) {
+        std::vector<uint64_t> planes(num_planes * block_words);
+        for (size_t first = lo; first < hi; first += block_words) {
+            size_t n = std::min(hi - first, block_words);
+            std::fill(planes.begin(), planes.end(), 0);
+            for (const BitArray *a : arrays) {
+                const uint64_t *src = a->data() + first;
+                for (size_t i = 0; i < n; i++) {
+                    // Add the input word to the counters, rippling the carry
+                    // up.
+                    uint64_t carry = src[i];
+                    for (size_t p = 0; carry != 0; p++) {
+                        uint64_t &plane = planes[p * block_words + i];
+                        uint64_t next = plane & carry;
+                        plane ^= carry;
+                        carry = next;
+                    }
+                }
+            }
+            // Compare the counters with k from the top bit down: a counter
+            // is greater once it has a 1 where k has a 0 and all higher bits
+            // agree.
+            for (size_t i = 0; i < n; i++) {
+                uint64_t greater = 0;
+                uint64_t equal = ~uint64_t{0};
+                for (size_t p = num_planes; p-- > 0;) {
+                    uint64_t plane = planes[p * block_words + i];
+                    if ((k >> p) & 1) {
+                        equal &= plane;
+                    } else {
+                        greater |= equal & plane;
+                        equal &= ~plane;
+                    }
+                }
+                dst[first + i] = greater | equal;
+            }
+        }
+    });
+    return res;
+}
@@ -0,0 +1,207 @@
+#include "bit_span.h"
+#include "bit_kernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace {
+
+void check_range(size_t size, size_t pos, size_t len) {
+    if (pos > size || len > size - pos) {
+        throw std::invalid_argument("Error: bit range out of range");
+    }
+}
+
+} // namespace
+
+ConstBitSpan::ConstBitSpan(const uint64_t *words, size_t offset, size_t size)
+    : words(words + offset / 64), offset(offset % 64), bits_size(size) {}
+
+ConstBitSpan::ConstBitSpan(const BitArray &bits)
+    : owner(&bits), words(bits.data()), bits_size(bits.size()) {}
+
+ConstBitSpan::ConstBitSpan(const BitArray &bits, size_t pos, size_t len)
+    : ConstBitSpan(bits) {
+    check_range(bits.size(), pos, len);
+    *this = subspan(pos, len);
+}
+
+ConstBitSpan ConstBitSpan::subspan(size_t pos, size_t len) const {
+    check_range(bits_size, pos, len);
+    ConstBitSpan res(words, offset + pos, len);
+    res.owner = owner;
+    return res;
+}
+
+size_t ConstBitSpan::count() const {
+    if (offset != 0) {
+        return Base::count();
+    }
+    // An aligned view is a plain run of words and a partial last word.
+    size_t full_words = bits_size / 64;
+    size_t cnt = bit_kernels::active().count_bytes(
+        reinterpret_cast<const unsigned char *>(words),
+        full_words * sizeof(uint64_t));
+    if (bits_size % 64 != 0) {
+        cnt += std::popcount(word(full_words));
+    }
+    return cnt;
+}
+
+size_t ConstBitSpan::find_first() const {
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        uint64_t w = word(i);
+        if (w != 0) {
+            return i * 64 + std::countr_zero(w);
+        }
+    }
+    return npos;
+}
+
+size_t ConstBitSpan::find_next(size_t pos) const {
+    if (pos >= bits_size || pos + 1 >= bits_size) {
+        return npos;
+    }
+    pos++;
+    size_t i = pos / 64;
+    uint64_t w = word(i) & (~uint64_t{0} << (pos % 64));
+    while (w == 0) {
+        if (++i == num_words()) {
+            return npos;
+        }
+        w = word(i);
+    }
+    return i * 64 + std::countr_zero(w);
+}
+
+BitArray ConstBitSpan::to_bit_array() const { return BitArray(*this); }
+
+bool operator==(const ConstBitSpan &a, const ConstBitSpan &b) {
+    if (a.bits_size != b.bits_size) {
+        return false;
+    }
+    for (size_t i = 0, n = a.num_words(); i < n; i++) {
+        if (a.word(i) != b.word(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator!=(const ConstBitSpan &a, const ConstBitSpan &b) {
+    return !(a == b);
+}
+
+bool operator==(const ConstBitSpan &a, const BitArray &b) {
+    return a == ConstBitSpan(b);
+}
+
+BitSpan::BitSpan(uint64_t *words, size_t offset, size_t size)
+    : ConstBitSpan(words, offset, size) {}
+
+// The non-const data() gives the array a block of its own first, so that
+// writes through the view do not reach copies sharing the old one.
+BitSpan::BitSpan(BitArray &bits) : ConstBitSpan(bits.data(), 0, bits.size()) {
+    owner = &bits;
+}
+
+BitSpan::BitSpan(BitArray &bits, size_t pos, size_t len) : BitSpan(bits) {
+    check_range(bits.size(), pos, len);
+    static_cast<ConstBitSpan &>(*this) = ConstBitSpan::subspan(pos, len);
+}
+
+BitSpan BitSpan::subspan(size_t pos, size_t len) const {
+    BitSpan res;
+    static_cast<ConstBitSpan &>(res) = ConstBitSpan::subspan(pos, len);
+    return res;
+}
+
+const BitSpan &BitSpan::set(size_t n, bool val) const {
+    if (n >= bits_size) {
+        throw std::invalid_argument("Error: bit index out of range");
+    }
+    uint64_t bit = uint64_t{1} << (n % 64);
+    store(n / 64, val ? bit : 0, bit);
+    return *this;
+}
+
+const BitSpan &BitSpan::set() const {
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        store(i, ~uint64_t{0}, bit_expr::prefix_mask(bits_size, i));
+    }
+    return *this;
+}
+
+const BitSpan &BitSpan::reset(size_t n) const { return set(n, false); }
+
+const BitSpan &BitSpan::reset() const {
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        store(i, 0, bit_expr::prefix_mask(bits_size, i));
+    }
+    return *this;
+}
+
+const BitSpan &BitSpan::flip() const {
+    for (size_t i = 0, n = num_words(); i < n; i++) {
+        store(i, ~word(i), bit_expr::prefix_mask(bits_size, i));
+    }
+    return *this;
+}
+
+const BitSpan &BitSpan::assign(const ConstBitSpan &src) const {
+    combine(src, [](uint64_t, uint64_t b) { return b; });
+    return *this;
+}
+
+const BitSpan &BitSpan::operator&=(const ConstBitSpan &src) const {
+    combine(src, [](uint64_t a, uint64_t b) { return a & b; });
+    return *this;
+}
+
+const BitSpan &BitSpan::operator|=(const ConstBitSpan &src) const {
+    combine(src, [](uint64_t a, uint64_t b) { return a | b; });
+    return *this;
+}
+
+const BitSpan &BitSpan::operator^=(const ConstBitSpan &src) const {
+    combine(src, [](uint64_t a, uint64_t b) { return a ^ b; });
+    return *this;
+}
+
+void BitSpan::store(size_t i, uint64_t value, uint64_t mask) const {
+    // The view was made from non-const words.
+    auto *dst = const_cast<uint64_t *>(words);
+    size_t bit = offset + 64 * i;
+    size_t w = bit / 64;
+    size_t shift = bit % 64;
+    value &= mask;
+    dst[w] = (dst[w] & ~(mask << shift)) | (value << shift);
+    if (shift != 0) {
+        uint64_t high_mask = mask >> (64 - shift);
+        if (high_mask != 0) {
+            dst[w + 1] = (dst[w + 1] & ~high_mask) | (value >> (64 - shift));
+        }
+    }
+}
+
+template <class Op>
+void BitSpan::combine(const ConstBitSpan &src, Op op) const {
+    size_t common_bits = std::min(bits_size, src.size());
+    size_t full_words = common_bits / 64;
+    if (offset == 0) {
+        // Whole words of an aligned view are written directly.
+        auto *dst = const_cast<uint64_t *>(words);
+        for (size_t i = 0; i < full_words; i++) {
+            dst[i] = op(dst[i], src.word(i));
+        }
+    } else {
+        for (size_t i = 0; i < full_words; i++) {
+            store(i, op(word(i), src.word(i)), ~uint64_t{0});
+        }
+    }
+    if (common_bits % 64 != 0) {
+        store(full_words, op(word(full_words), src.word(full_words)),
+              bit_expr::prefix_mask(common_bits, full_words));
+    }
+}
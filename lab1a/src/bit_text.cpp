@@ -0,0 +1,298 @@
+#include "bit_text.h"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <string>
+
+namespace bit_text {
+namespace {
+
+/*!
+ * The eight characters for every byte value, highest bit first, packed into
+ * a little-endian word so that a byte expands with a single store.
+ */
+constexpr std::array<uint64_t, 256> char_table = [] {
+    std::array<uint64_t, 256> table{};
+    for (size_t b = 0; b < 256; b++) {
+        for (size_t k = 0; k < 8; k++) {
+            uint64_t c = (b >> (7 - k)) & 1 ? '1' : '0';
+            table[b] |= c << (8 * k);
+        }
+    }
+    return table;
+}();
+
+constexpr char hex_chars[] = "0123456789abcdef";
+
+/*!
+ * Returns the value of the hex digit `c`, or -1 if it is not one.
+ */
+int hex_value(int c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+int raw_index() {
+    static const int index = std::ios_base::xalloc();
+    return index;
+}
+
+bool is_raw(std::ios_base &s) { return s.iword(raw_index()) != 0; }
+
+bool is_hex(std::ios_base &s) {
+    return (s.flags() & std::ios_base::basefield) == std::ios_base::hex;
+}
+
+void to_hex(const unsigned char *bytes, size_t num_bits, char *out) {
+    size_t digits = (num_bits + 3) / 4;
+    for (size_t i = 0; i < digits; i++) {
+        size_t nibble = digits - 1 - i;
+        out[i] = hex_chars[(bytes[nibble / 2] >> (4 * (nibble % 2))) & 0xF];
+    }
+}
+
+bool from_hex(const char *in, size_t digits, unsigned char *bytes) {
+    for (size_t i = 0; i < digits; i++) {
+        int value = hex_value(static_cast<unsigned char>(in[i]));
+        if (value < 0) {
+            return false;
+        }
+        size_t nibble = digits - 1 - i;
+        bytes[nibble / 2] |= value << (4 * (nibble % 2));
+    }
+    return true;
+}
+
+/*!
+ * Write the '0' and '1' characters for `num_bits` bits through a small
+ * buffer, so that large arrays do not need a string of their own.
+ */
+std::ostream &write_chars(std::ostream &os, const unsigned char *bytes,
+                          size_t num_bits) {
+    constexpr size_t block_bytes = 4096;
+    char buf[8 * block_bytes];
+    size_t rem = num_bits % 8;
+    to_chars(bytes + num_bits / 8, rem, buf);
+    os.write(buf, static_cast<std::streamsize>(rem));
+    for (size_t hi = num_bits / 8; hi > 0;) {
+        size_t lo = hi > block_bytes ? hi - block_bytes : 0;
+        to_chars(bytes + lo, 8 * (hi - lo), buf);
+        os.write(buf, static_cast<std::streamsize>(8 * (hi - lo)));
+        hi = lo;
+    }
+    return os;
+}
+
+std::ostream &write_raw(std::ostream &os, const unsigned char *bytes,
+                        size_t num_bits) {
+    unsigned char header[8];
+    for (size_t i = 0; i < 8; i++) {
+        header[i] = static_cast<unsigned char>(uint64_t{num_bits} >> (8 * i));
+    }
+    os.write(reinterpret_cast<const char *>(header), sizeof(header));
+    size_t num_bytes = (num_bits + 7) / 8;
+    os.write(reinterpret_cast<const char *>(bytes),
+             static_cast<std::streamsize>(num_bytes));
+    const char padding[8] = {};
+    os.write(padding, static_cast<std::streamsize>((8 - num_bytes % 8) % 8));
+    return os;
+}
+
+/*!
+ * Returns the number of bytes left in `is`, or -1 if the stream cannot say.
+ */
+std::streamoff remaining(std::istream &is) {
+    std::streampos pos = is.tellg();
+    if (pos == std::streampos(-1)) {
+        return -1;
+    }
+    is.seekg(0, std::ios_base::end);
+    std::streampos end = is.tellg();
+    is.seekg(pos);
+    if (!is || end == std::streampos(-1)) {
+        is.clear(is.rdstate() & ~std::ios_base::failbit);
+        return -1;
+    }
+    return end - pos;
+}
+
+std::istream &
+read_raw(std::istream &is,
+         const std::function<unsigned char *(size_t)> &allocate) {
+    unsigned char header[8];
+    if (!is.read(reinterpret_cast<char *>(header), sizeof(header))) {
+        return is;
+    }
+    uint64_t num_bits = 0;
+    for (size_t i = 0; i < 8; i++) {
+        num_bits |= uint64_t{header[i]} << (8 * i);
+    }
+    // The count comes from the input, so it is checked before any size
+    // arithmetic on it here or in `allocate` can wrap.
+    if (num_bits > std::numeric_limits<size_t>::max() - 63) {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+    size_t num_bytes = static_cast<size_t>((num_bits + 7) / 8);
+    size_t padding = (8 - num_bytes % 8) % 8;
+    std::streamoff left = remaining(is);
+    if (left >= 0 &&
+        static_cast<uint64_t>(left) < uint64_t{num_bytes} + padding) {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+    // The bits are read straight into the array: a scratch copy would double
+    // the peak memory of a large array.
+    unsigned char *bytes;
+    try {
+        bytes = allocate(static_cast<size_t>(num_bits));
+    } catch (const std::bad_alloc &) {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+    char pad[8];
+    if (!is.read(reinterpret_cast<char *>(bytes),
+                 static_cast<std::streamsize>(num_bytes)) ||
+        !is.read(pad, static_cast<std::streamsize>(padding))) {
+        // Only a stream of unknown size gets here. The array is left empty
+        // rather than partly read.
+        allocate(0);
+        return is;
+    }
+    if (num_bits % 8 != 0) {
+        bytes[num_bytes - 1] &= (1u << (num_bits % 8)) - 1;
+    }
+    return is;
+}
+
+} // namespace
+
+void to_chars(const unsigned char *bytes, size_t num_bits, char *out) {
+    size_t full = num_bits / 8;
+    size_t rem = num_bits % 8;
+    for (size_t k = 0; k < rem; k++) {
+        out[k] = (bytes[full] >> (rem - 1 - k)) & 1 ? '1' : '0';
+    }
+    out += rem;
+    for (size_t j = full; j > 0; j--) {
+        std::memcpy(out, &char_table[bytes[j - 1]], 8);
+        out += 8;
+    }
+}
+
+bool from_chars(const char *in, size_t num_bits, unsigned char *bytes) {
+    constexpr uint64_t ones = 0x0101010101010101;
+    size_t full = num_bits / 8;
+    size_t rem = num_bits % 8;
+    for (size_t k = 0; k < rem; k++) {
+        if (in[k] != '0' && in[k] != '1') {
+            return false;
+        }
+        bytes[full] |= (in[k] - '0') << (rem - 1 - k);
+    }
+    in += rem;
+    for (size_t j = full; j > 0; j--) {
+        uint64_t chars;
+        std::memcpy(&chars, in, 8);
+        in += 8;
+        // Every byte must be '0' (0x30) or '1' (0x31).
+        if ((chars & ~ones) != ones * '0') {
+            return false;
+        }
+        // The multiply gathers the low bit of every byte into the top byte,
+        // the first character landing in the highest bit.
+        bytes[j - 1] = static_cast<unsigned char>(
+            ((chars & ones) * 0x8040201008040201) >> 56);
+    }
+    return true;
+}
+
+std::ios_base &rawbits(std::ios_base &s) {
+    s.iword(raw_index()) = 1;
+    return s;
+}
+
+std::ios_base &norawbits(std::ios_base &s) {
+    s.iword(raw_index()) = 0;
+    return s;
+}
+
+std::ostream &write(std::ostream &os, const unsigned char *bytes,
+                    size_t num_bits) {
+    if (is_raw(os)) {
+        return write_raw(os, bytes, num_bits);
+    }
+    if (!is_hex(os) && num_bits != 0) {
+        return write_chars(os, bytes, num_bits);
+    }
+    // The count is written in decimal whatever the base of the stream
+    std::string text = std::to_string(num_bits) + ':';
+    size_t prefix = text.size();
+    text.resize(prefix + (num_bits + 3) / 4);
+    to_hex(bytes, num_bits, text.data() + prefix);
+    return os.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+std::istream &read(std::istream &is,
+                   const std::function<unsigned char *(size_t)> &allocate) {
+    if (is_raw(is)) {
+        return read_raw(is, allocate);
+    }
+    std::string token;
+    if (!(is >> token)) {
+        return is;
+    }
+    bool hex = is_hex(is);
+    const char *digits = token.data();
+    size_t num_digits = token.size();
+    size_t num_bits = hex ? 4 * num_digits : num_digits;
+    bool ok = true;
+    size_t colon = token.find(':');
+    if (colon != std::string::npos) {
+        // The count must be plain decimal and match the digits after it
+        auto [end, ec] =
+            std::from_chars(token.data(), token.data() + colon, num_bits);
+        digits += colon + 1;
+        num_digits -= colon + 1;
+        ok = colon != 0 && ec == std::errc() && end == token.data() + colon &&
+             num_digits == (hex ? num_bits / 4 + (num_bits % 4 != 0)
+                                : num_bits);
+    }
+    // The bits are parsed into a scratch array first, so that `allocate`
+    // only sees valid input.
+    std::string bytes(ok ? (num_bits + 7) / 8 : 0, '\0');
+    auto *scratch = reinterpret_cast<unsigned char *>(bytes.data());
+    if (ok) {
+        ok = hex ? from_hex(digits, num_digits, scratch)
+                 : from_chars(digits, num_digits, scratch);
+    }
+    // A hex digit may not set bits past the count
+    if (ok && num_bits % 8 != 0) {
+        ok = (scratch[num_bits / 8] >> (num_bits % 8)) == 0;
+    }
+    if (!ok) {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+    unsigned char *dst = allocate(num_bits);
+    if (!bytes.empty()) {
+        std::memcpy(dst, bytes.data(), bytes.size());
+    }
+    return is;
+}
+
+} // namespace bit_text
@@ -0,0 +1,188 @@
+#include "bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BLOOM_PREFETCH(p) _mm_prefetch(reinterpret_cast<const char *>(p), 0)
+#elif defined(__GNUC__) || defined(__clang__)
+#define BLOOM_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define BLOOM_PREFETCH(p)
+#endif
+
+namespace {
+
+constexpr size_t block_bits = 512;
+constexpr size_t max_hashes = 16;
+
+// Keys are processed in batches of this many: enough to overlap the cache
+// misses, few enough that the prefetched lines stay in L1.
+constexpr size_t batch = 16;
+
+/*!
+ * Returns a well-mixed 64-bit hash of `x`.
+ */
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EB;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t hash_string(std::string_view key) {
+    uint64_t h = 0xCBF29CE484222325;
+    for (unsigned char c : key) {
+        h = (h ^ c) * 0x100000001B3;
+    }
+    return h;
+}
+
+/*!
+ * Returns the false positive rate of a blocked filter with `bits_per_key`
+ * bits per key and `k` hashes. The number of keys in a block follows a
+ * Poisson distribution, and each block acts as a classic Bloom filter.
+ */
+double blocked_rate(double bits_per_key, size_t k) {
+    double mean = block_bits / bits_per_key;
+    double rate = 0;
+    size_t last = static_cast<size_t>(mean + 10 * std::sqrt(mean) + 10);
+    for (size_t i = 0; i <= last; i++) {
+        double p = std::exp(i * std::log(mean) - mean - std::lgamma(i + 1.0));
+        double fill = 1 - std::pow(1 - 1.0 / block_bits, double(i * k));
+        rate += p * std::pow(fill, double(k));
+    }
+    return rate;
+}
+
+/*!
+ * Call `visit(word, mask)` for each of the `k` bits of the key hash `h`
+ * inside its block. Every bit takes 9 fresh hash bits, seven per rehash;
+ * double hashing inside a block this small gives visibly more false
+ * positives.
+ */
+template <class Visit>
+void for_each_bit(uint64_t h, size_t k, Visit visit) {
+    uint64_t g = h;
+    for (size_t i = 0; i < k; i++) {
+        if (i % 7 == 0) {
+            g = mix(g + 0x9E3779B97F4A7C15);
+        }
+        size_t bit = g % block_bits;
+        visit(bit / 64, uint64_t{1} << (bit % 64));
+        g >>= 9;
+    }
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(size_t expected_keys, double false_positive_rate) {
+    if (!(false_positive_rate > 0 && false_positive_rate < 1)) {
+        throw std::invalid_argument("Error: false positive rate out of range");
+    }
+    // Start from the size of a classic Bloom filter and grow it until the
+    // blocked filter reaches the wanted rate.
+    double ln2 = std::log(2.0);
+    double bits_per_key = -std::log(false_positive_rate) / (ln2 * ln2);
+    for (int step = 0; step < 200; step++) {
+        hashes = std::clamp<size_t>(std::lround(bits_per_key * ln2), 1,
+                                    max_hashes);
+        if (blocked_rate(bits_per_key, hashes) <= false_positive_rate) {
+            break;
+        }
+        bits_per_key *= 1.02;
+    }
+
+    double total_bits = bits_per_key * std::max<size_t>(expected_keys, 1);
+    num_blocks = std::max<size_t>(
+        1, static_cast<size_t>(std::ceil(total_bits / block_bits)));
+    bits = BitArray((num_blocks + 1) * block_bits);
+    auto address = reinterpret_cast<uintptr_t>(bits.data());
+    first_word = (block_words - address / 8 % block_words) % block_words;
+}
+
+void BloomFilter::insert(uint64_t key) {
+    uint64_t h = mix(key);
+    uint64_t *words = block(h);
+    for_each_bit(h, hashes,
+                 [&](size_t w, uint64_t mask) { words[w] |= mask; });
+}
+
+void BloomFilter::insert(std::string_view key) { insert(hash_string(key)); }
+
+bool BloomFilter::contains(uint64_t key) const {
+    uint64_t h = mix(key);
+    const uint64_t *words = block(h);
+    bool found = true;
+    for_each_bit(h, hashes, [&](size_t w, uint64_t mask) {
+        found &= (words[w] & mask) != 0;
+    });
+    return found;
+}
+
+bool BloomFilter::contains(std::string_view key) const {
+    return contains(hash_string(key));
+}
+
+void BloomFilter::insert_many(std::span<const uint64_t> keys) {
+    uint64_t h[batch];
+    for (size_t first = 0; first < keys.size(); first += batch) {
+        size_t n = std::min(batch, keys.size() - first);
+        for (size_t i = 0; i < n; i++) {
+            h[i] = mix(keys[first + i]);
+            BLOOM_PREFETCH(block(h[i]));
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t *words = block(h[i]);
+            for_each_bit(h[i], hashes,
+                         [&](size_t w, uint64_t mask) { words[w] |= mask; });
+        }
+    }
+}
+
+void BloomFilter::contains_many(std::span<const uint64_t> keys,
+                                std::span<bool> results) const {
+    if (keys.size() != results.size()) {
+        throw std::invalid_argument("Error: result size mismatch");
+    }
+    uint64_t h[batch];
+    for (size_t first = 0; first < keys.size(); first += batch) {
+        size_t n = std::min(batch, keys.size() - first);
+        for (size_t i = 0; i < n; i++) {
+            h[i] = mix(keys[first + i]);
+            BLOOM_PREFETCH(block(h[i]));
+        }
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t *words = block(h[i]);
+            bool found = true;
+            for_each_bit(h[i], hashes, [&](size_t w, uint64_t mask) {
+                found &= (words[w] & mask) != 0;
+            });
+            results[first + i] = found;
+        }
+    }
+}
+
+void BloomFilter::clear() { bits.reset(); }
+
+size_t BloomFilter::num_bits() const { return num_blocks * block_bits; }
+
+size_t BloomFilter::num_hashes() const { return hashes; }
+
+size_t BloomFilter::block_offset(uint64_t h) const {
+    // The high half of the hash picks the block without a division.
+    size_t index = static_cast<size_t>(((h >> 32) * num_blocks) >> 32);
+    return first_word + index * block_words;
+}
+
+const uint64_t *BloomFilter::block(uint64_t h) const {
+    return bits.data() + block_offset(h);
+}
+
+uint64_t *BloomFilter::block(uint64_t h) {
+    return bits.data() + block_offset(h);
+}
@@ -0,0 +1,303 @@
+#include "mapped_bit_array.h"
+#include "bit_kernels.h"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char magic[8] = {'B', 'I', 'T', 'A', 'R', 'R', 'A', 'Y'};
+constexpr uint32_t version = 1;
+
+/*!
+ * The file header. The words follow it, so it is padded to keep them on a
+ * cache line boundary of the mapping.
+ */
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t word_bits;
+    uint64_t bit_length;
+    uint64_t checksum;
+    unsigned char reserved[32];
+};
+
+static_assert(sizeof(Header) == 64);
+
+/*!
+ * Returns a 64-bit checksum of the `n` words `word(0)` to `word(n - 1)`.
+ * Four independent lanes keep the loop bound by memory bandwidth rather than
+ * by the multiply latency.
+ */
+template <class Word>
+uint64_t checksum(size_t n, Word word) {
+    constexpr uint64_t prime = 0x9E3779B97F4A7C15;
+    uint64_t h[4] = {prime, prime * 3, prime * 5, prime * 7};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            h[lane] = std::rotl(h[lane] ^ word(i + lane), 31) * prime;
+        }
+    }
+    for (; i < n; i++) {
+        h[0] = std::rotl(h[0] ^ word(i), 31) * prime;
+    }
+    return h[0] ^ std::rotl(h[1], 16) ^ std::rotl(h[2], 32) ^
+           std::rotl(h[3], 48) ^ n;
+}
+
+uint64_t checksum(const uint64_t *words, size_t n) {
+    return checksum(n, [words](size_t i) { return words[i]; });
+}
+
+// The checksum of `n` zero words, computed without any memory to read
+uint64_t zero_checksum(size_t n) {
+    return checksum(n, [](size_t) { return uint64_t{0}; });
+}
+
+Header make_header(size_t num_bits, uint64_t sum) {
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.word_bits = 64;
+    header.bit_length = num_bits;
+    header.checksum = sum;
+    return header;
+}
+
+size_t word_count(size_t num_bits) { return (num_bits + 63) / 64; }
+
+} // namespace
+
+MappedBitArray::MappedBitArray(const std::string &path, Mode mode)
+    : mode(mode) {
+    bool write = mode == Mode::read_write;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+        FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error opening bit array file.");
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Error reading bit array file size.");
+    }
+    mapped_bytes = static_cast<size_t>(file_size.QuadPart);
+    HANDLE mapping = nullptr;
+    if (mapped_bytes >= sizeof(Header)) {
+        mapping = CreateFileMappingA(file, nullptr,
+                                     write ? PAGE_READWRITE : PAGE_READONLY, 0,
+                                     0, nullptr);
+    }
+    if (mapping != nullptr) {
+        base = static_cast<unsigned char *>(MapViewOfFile(
+            mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+        // The view keeps the mapping and the file open.
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), write ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Error opening bit array file.");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Error reading bit array file size.");
+    }
+    mapped_bytes = static_cast<size_t>(st.st_size);
+    if (mapped_bytes >= sizeof(Header)) {
+        void *p = ::mmap(nullptr, mapped_bytes,
+                         write ? PROT_READ | PROT_WRITE : PROT_READ,
+                         MAP_SHARED, fd, 0);
+        base = p == MAP_FAILED ? nullptr : static_cast<unsigned char *>(p);
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+#endif
+    if (mapped_bytes < sizeof(Header)) {
+        throw std::runtime_error("Error: bit array file is too short.");
+    }
+    if (base == nullptr) {
+        throw std::runtime_error("Error mapping bit array file.");
+    }
+
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.version != version || header.word_bits != 64) {
+        unmap();
+        throw std::runtime_error("Error: not a bit array file.");
+    }
+    if (header.bit_length > (mapped_bytes - sizeof(Header)) * 8 ||
+        mapped_bytes - sizeof(Header) !=
+            word_count(header.bit_length) * sizeof(uint64_t)) {
+        unmap();
+        throw std::runtime_error("Error: bit array file size mismatch.");
+    }
+    bits_size = header.bit_length;
+}
+
+MappedBitArray MappedBitArray::create(const std::string &path,
+                                      size_t num_bits) {
+    size_t num_words = word_count(num_bits);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        Header header = make_header(num_bits, zero_checksum(num_words));
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!out) {
+            throw std::runtime_error("Error creating bit array file.");
+        }
+    }
+    // Growing the file fills it with zeros without writing them, and the
+    // header already holds their checksum, so no page of the words is read
+    // or written until the array is used.
+    std::filesystem::resize_file(path,
+                                 sizeof(Header) + num_words * sizeof(uint64_t));
+    return MappedBitArray(path, Mode::read_write);
+}
+
+void MappedBitArray::save(const BitArray &bits, const std::string &path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    Header header =
+        make_header(bits.size(), checksum(bits.data(), bits.num_words()));
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(bits.data()),
+              static_cast<std::streamsize>(bits.num_words() *
+                                           sizeof(uint64_t)));
+    if (!out) {
+        throw std::runtime_error("Error writing bit array file.");
+    }
+}
+
+MappedBitArray::MappedBitArray(MappedBitArray &&b) noexcept
+    : base(std::exchange(b.base, nullptr)),
+      mapped_bytes(std::exchange(b.mapped_bytes, 0)),
+      bits_size(std::exchange(b.bits_size, 0)), mode(b.mode),
+      dirty(std::exchange(b.dirty, false)) {}
+
+MappedBitArray &MappedBitArray::operator=(MappedBitArray &&b) noexcept {
+    if (this != &b) {
+        unmap();
+        base = std::exchange(b.base, nullptr);
+        mapped_bytes = std::exchange(b.mapped_bytes, 0);
+        bits_size = std::exchange(b.bits_size, 0);
+        mode = b.mode;
+        dirty = std::exchange(b.dirty, false);
+    }
+    return *this;
+}
+
+MappedBitArray::~MappedBitArray() { unmap(); }
+
+MappedBitArray &MappedBitArray::set(size_t n, bool val) {
+    if (n >= bits_size) {
+        throw std::invalid_argument("Error: bit index out of range");
+    }
+    uint64_t bit = uint64_t{1} << (n % 64);
+    uint64_t &word = mutable_data()[n / 64];
+    word = val ? word | bit : word & ~bit;
+    return *this;
+}
+
+MappedBitArray &MappedBitArray::reset(size_t n) { return set(n, false); }
+
+bool MappedBitArray::operator[](size_t i) const {
+    return (data()[i / 64] >> (i % 64)) & 1;
+}
+
+size_t MappedBitArray::count() const {
+    return bit_kernels::active().count_bytes(
+        base + sizeof(Header), num_words() * sizeof(uint64_t));
+}
+
+bool MappedBitArray::any() const {
+    return bit_kernels::active().any_bytes(base + sizeof(Header),
+                                           num_words() * sizeof(uint64_t));
+}
+
+bool MappedBitArray::none() const { return !any(); }
+
+size_t MappedBitArray::size() const { return bits_size; }
+
+size_t MappedBitArray::num_words() const { return word_count(bits_size); }
+
+const uint64_t *MappedBitArray::data() const {
+    return reinterpret_cast<const uint64_t *>(base + sizeof(Header));
+}
+
+uint64_t *MappedBitArray::mutable_data() {
+    if (mode != Mode::read_write) {
+        throw std::logic_error("Error: bit array file is read-only");
+    }
+    dirty = true;
+    return reinterpret_cast<uint64_t *>(base + sizeof(Header));
+}
+
+bool MappedBitArray::writable() const { return mode == Mode::read_write; }
+
+BitArray MappedBitArray::to_bit_array() const {
+    BitArray res(bits_size);
+    std::memcpy(res.data(), data(), num_words() * sizeof(uint64_t));
+    return res;
+}
+
+void MappedBitArray::flush() {
+    if (!dirty) {
+        return;
+    }
+    uint64_t sum = checksum(data(), num_words());
+    std::memcpy(base + offsetof(Header, checksum), &sum, sizeof(sum));
+#ifdef _WIN32
+    bool ok = FlushViewOfFile(base, mapped_bytes) != 0;
+#else
+    bool ok = ::msync(base, mapped_bytes, MS_SYNC) == 0;
+#endif
+    if (!ok) {
+        throw std::runtime_error("Error flushing bit array file.");
+    }
+    dirty = false;
+}
+
+bool MappedBitArray::verify() const {
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    return header.checksum == checksum(data(), num_words());
+}
+
+void MappedBitArray::unmap() {
+    if (base == nullptr) {
+        return;
+    }
+    if (dirty) {
+        // A destructor cannot report errors; the words themselves are
+        // written back by the system either way.
+        try {
+            flush();
+        } catch (const std::runtime_error &) {
+        }
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+#else
+    ::munmap(base, mapped_bytes);
+#endif
+    base = nullptr;
+}
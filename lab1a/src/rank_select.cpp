@@ -0,0 +1,114 @@
+#include "rank_select.h"
+
+#include <bit>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t block_words = 8;
+constexpr size_t block_bits = block_words * 64;
+constexpr size_t select_sample = 512;
+
+/*!
+ * Returns the position of the set bit with index `k` inside `word`.
+ */
+size_t select_in_word(uint64_t word, size_t k) {
+    size_t pos = 0;
+    for (;;) {
+        size_t byte_count = std::popcount(word & 0xFF);
+        if (k < byte_count) {
+            break;
+        }
+        k -= byte_count;
+        word >>= 8;
+        pos += 8;
+    }
+    for (; k > 0; k--) {
+        word &= word - 1;
+    }
+    return pos + std::countr_zero(word);
+}
+
+} // namespace
+
+RankSelect::RankSelect(const BitArray &bits)
+    : words(bits.data()), num_words(bits.num_words()),
+      bits_size(bits.size()) {
+    size_t blocks = (num_words + block_words - 1) / block_words;
+    counts.reserve(2 * (blocks + 1));
+
+    size_t next_sample = 0;
+    for (size_t block = 0; block < blocks; block++) {
+        uint64_t packed = 0;
+        size_t inside = 0;
+        for (size_t sub = 0; sub < block_words; sub++) {
+            if (sub > 0) {
+                packed |= uint64_t{inside} << (9 * (sub - 1));
+            }
+            size_t word = block * block_words + sub;
+            if (word < num_words) {
+                inside += std::popcount(words[word]);
+            }
+        }
+        counts.push_back(ones);
+        counts.push_back(packed);
+
+        ones += inside;
+        for (; next_sample < ones; next_sample += select_sample) {
+            samples.push_back(block);
+        }
+    }
+    // A sentinel block lets rank(size()) and select() read one past the end.
+    counts.push_back(ones);
+    counts.push_back(0);
+}
+
+size_t RankSelect::rank(size_t i) const {
+    if (i > bits_size) {
+        throw std::out_of_range("Index out of range");
+    }
+    size_t word = i / 64;
+    size_t result = block_rank(word / block_words, word % block_words);
+    if (i % 64 != 0) {
+        result += std::popcount(words[word] & ((uint64_t{1} << i % 64) - 1));
+    }
+    return result;
+}
+
+size_t RankSelect::select(size_t k) const {
+    if (k >= ones) {
+        throw std::out_of_range("Index out of range");
+    }
+    // The samples bound the search to the blocks between two sampled bits.
+    size_t sample = k / select_sample;
+    size_t lo = samples[sample];
+    size_t hi = sample + 1 < samples.size() ? samples[sample + 1]
+                                            : counts.size() / 2 - 2;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo + 1) / 2;
+        if (counts[2 * mid] <= k) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    size_t sub = 0;
+    while (sub + 1 < block_words && block_rank(lo, sub + 1) <= k) {
+        sub++;
+    }
+    size_t word = lo * block_words + sub;
+    return word * 64 + select_in_word(words[word], k - block_rank(lo, sub));
+}
+
+size_t RankSelect::count() const { return ones; }
+
+size_t RankSelect::size() const { return bits_size; }
+
+size_t RankSelect::block_rank(size_t block, size_t sub) const {
+    size_t result = counts[2 * block];
+    if (sub > 0) {
+        result += (counts[2 * block + 1] >> (9 * (sub - 1))) & 0x1FF;
+    }
+    return result;
+}
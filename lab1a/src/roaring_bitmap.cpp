@@ -0,0 +1,627 @@
+#include "roaring_bitmap.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+using roaring_detail::array_max;
+using roaring_detail::chunk_bits;
+using roaring_detail::chunk_words;
+using roaring_detail::Container;
+using roaring_detail::Kind;
+
+namespace {
+
+using Words = std::array<uint64_t, chunk_words>;
+
+/*!
+ * Set the bits `first` to `last`, inclusive, of a chunk bitmap.
+ */
+void set_bits(uint64_t *words, size_t first, size_t last) {
+    size_t first_word = first / 64;
+    size_t last_word = last / 64;
+    uint64_t head = ~uint64_t{0} << (first % 64);
+    uint64_t tail = ~uint64_t{0} >> (63 - last % 64);
+    if (first_word == last_word) {
+        words[first_word] |= head & tail;
+        return;
+    }
+    words[first_word] |= head;
+    std::fill(words + first_word + 1, words + last_word, ~uint64_t{0});
+    words[last_word] |= tail;
+}
+
+/*!
+ * Write the contents of `c` into `words`.
+ */
+void to_words(const Container &c, Words &words) {
+    switch (c.kind) {
+    case Kind::array:
+        words.fill(0);
+        for (uint16_t v : c.values) {
+            words[v / 64] |= uint64_t{1} << (v % 64);
+        }
+        break;
+    case Kind::bitmap:
+        std::copy(c.words.begin(), c.words.end(), words.begin());
+        break;
+    case Kind::run:
+        words.fill(0);
+        for (size_t i = 0; i < c.values.size(); i += 2) {
+            set_bits(words.data(), c.values[i], c.values[i + 1]);
+        }
+        break;
+    }
+}
+
+/*!
+ * Returns the index of the first bit at or after `pos` that equals `value`,
+ * or `chunk_bits` if there is none.
+ */
+size_t find_bit(const Words &words, size_t pos, bool value) {
+    if (pos >= chunk_bits) {
+        return chunk_bits;
+    }
+    size_t i = pos / 64;
+    uint64_t word = (value ? words[i] : ~words[i]) & (~uint64_t{0} << pos % 64);
+    while (word == 0) {
+        if (++i == chunk_words) {
+            return chunk_bits;
+        }
+        word = value ? words[i] : ~words[i];
+    }
+    return i * 64 + std::countr_zero(word);
+}
+
+/*!
+ * Build the smallest container holding the bits of `words`.
+ */
+Container from_words(const Words &words) {
+    size_t cardinality = 0;
+    size_t runs = 0;
+    uint64_t carry = 0;
+    for (uint64_t word : words) {
+        cardinality += std::popcount(word);
+        // A run starts at every set bit whose lower neighbour is clear.
+        runs += std::popcount(word & ~((word << 1) | carry));
+        carry = word >> 63;
+    }
+
+    Container c;
+    c.cardinality = static_cast<uint32_t>(cardinality);
+    size_t array_bytes = cardinality <= array_max ? 2 * cardinality
+                                                  : 8 * chunk_words;
+    if (4 * runs < array_bytes) {
+        c.kind = Kind::run;
+        c.values.reserve(2 * runs);
+        for (size_t start = find_bit(words, 0, true); start < chunk_bits;) {
+            size_t end = find_bit(words, start, false);
+            c.values.push_back(static_cast<uint16_t>(start));
+            c.values.push_back(static_cast<uint16_t>(end - 1));
+            start = find_bit(words, end, true);
+        }
+    } else if (cardinality <= array_max) {
+        c.kind = Kind::array;
+        c.values.reserve(cardinality);
+        for (size_t i = 0; i < chunk_words; i++) {
+            for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                c.values.push_back(
+                    static_cast<uint16_t>(i * 64 + std::countr_zero(word)));
+            }
+        }
+    } else {
+        c.kind = Kind::bitmap;
+        c.words.assign(words.begin(), words.end());
+    }
+    return c;
+}
+
+/*!
+ * Rebuild `c` in its smallest representation.
+ */
+void optimize(Container &c) {
+    Words words;
+    to_words(c, words);
+    c = from_words(words);
+}
+
+/*!
+ * Build a container from sorted, unique values.
+ */
+Container from_values(std::vector<uint16_t> values) {
+    Container c;
+    c.cardinality = static_cast<uint32_t>(values.size());
+    c.values = std::move(values);
+    if (c.cardinality > array_max) {
+        optimize(c);
+    }
+    return c;
+}
+
+/*!
+ * Returns the number of runs of a run container that start at or before
+ * `v`; the last of them is the only one that can hold `v`.
+ */
+size_t runs_before(const Container &c, uint16_t v) {
+    size_t lo = 0;
+    size_t hi = c.values.size() / 2;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (c.values[2 * mid] <= v) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*!
+ * Returns true if `from_words` would keep the runs of `c` as they are.
+ */
+bool runs_fit(const Container &c) {
+    size_t array_bytes =
+        c.cardinality <= array_max ? 2 * c.cardinality : 8 * chunk_words;
+    return 2 * c.values.size() < array_bytes;
+}
+
+bool contains(const Container &c, uint16_t v) {
+    switch (c.kind) {
+    case Kind::array:
+        return std::binary_search(c.values.begin(), c.values.end(), v);
+    case Kind::bitmap:
+        return (c.words[v / 64] >> (v % 64)) & 1;
+    case Kind::run: {
+        size_t lo = runs_before(c, v);
+        return lo > 0 && v <= c.values[2 * (lo - 1) + 1];
+    }
+    }
+    return false;
+}
+
+/*!
+ * Add `v`, which is not in `c`, to a run container, extending or joining
+ * the runs next to it.
+ */
+void add_to_runs(Container &c, uint16_t v) {
+    size_t next = runs_before(c, v);
+    bool joins_prev = next > 0 && c.values[2 * next - 1] + 1 == v;
+    bool joins_next =
+        2 * next < c.values.size() && c.values[2 * next] == v + 1;
+    auto at = c.values.begin() + 2 * next;
+    if (joins_prev && joins_next) {
+        // The end of the previous run becomes the end of the next one.
+        c.values[2 * next - 1] = c.values[2 * next + 1];
+        c.values.erase(at, at + 2);
+    } else if (joins_prev) {
+        c.values[2 * next - 1] = v;
+    } else if (joins_next) {
+        c.values[2 * next] = v;
+    } else {
+        c.values.insert(at, {v, v});
+    }
+    c.cardinality++;
+}
+
+/*!
+ * Remove `v`, which is in `c`, from a run container, shrinking or splitting
+ * the run that holds it.
+ */
+void remove_from_runs(Container &c, uint16_t v) {
+    size_t run = runs_before(c, v) - 1;
+    uint16_t &start = c.values[2 * run];
+    uint16_t &end = c.values[2 * run + 1];
+    auto at = c.values.begin() + 2 * run;
+    if (start == end) {
+        c.values.erase(at, at + 2);
+    } else if (v == start) {
+        start++;
+    } else if (v == end) {
+        end--;
+    } else {
+        uint16_t old_end = end;
+        end = v - 1;
+        c.values.insert(at + 2, {static_cast<uint16_t>(v + 1), old_end});
+    }
+    c.cardinality--;
+}
+
+void add(Container &c, uint16_t v) {
+    switch (c.kind) {
+    case Kind::array: {
+        auto it = std::lower_bound(c.values.begin(), c.values.end(), v);
+        if (it == c.values.end() || *it != v) {
+            c.values.insert(it, v);
+            c.cardinality++;
+            if (c.cardinality > array_max) {
+                optimize(c);
+            }
+        }
+        break;
+    }
+    case Kind::bitmap:
+        if (!contains(c, v)) {
+            c.words[v / 64] |= uint64_t{1} << (v % 64);
+            c.cardinality++;
+        }
+        break;
+    case Kind::run:
+        if (!contains(c, v)) {
+            add_to_runs(c, v);
+            if (!runs_fit(c)) {
+                optimize(c);
+            }
+        }
+        break;
+    }
+}
+
+void remove(Container &c, uint16_t v) {
+    if (!contains(c, v)) {
+        return;
+    }
+    switch (c.kind) {
+    case Kind::array:
+        c.values.erase(std::lower_bound(c.values.begin(), c.values.end(), v));
+        c.cardinality--;
+        break;
+    case Kind::bitmap:
+        c.words[v / 64] &= ~(uint64_t{1} << (v % 64));
+        c.cardinality--;
+        if (c.cardinality <= array_max) {
+            optimize(c);
+        }
+        break;
+    case Kind::run:
+        remove_from_runs(c, v);
+        if (!runs_fit(c)) {
+            optimize(c);
+        }
+        break;
+    }
+}
+
+/*!
+ * Combine two containers. Two arrays are merged directly with `merge`;
+ * every other pair goes through bitmaps combined with `op`.
+ */
+template <class Merge, class Op>
+Container combine(const Container &a, const Container &b, Merge merge,
+                  Op op) {
+    if (a.kind == Kind::array && b.kind == Kind::array) {
+        std::vector<uint16_t> values;
+        merge(a.values.begin(), a.values.end(), b.values.begin(),
+              b.values.end(), std::back_inserter(values));
+        return from_values(std::move(values));
+    }
+    Words x;
+    Words y;
+    to_words(a, x);
+    to_words(b, y);
+    for (size_t i = 0; i < chunk_words; i++) {
+        x[i] = op(x[i], y[i]);
+    }
+    return from_words(x);
+}
+
+Container intersect(const Container &a, const Container &b) {
+    // A small array is filtered against the other container directly.
+    if (a.kind == Kind::array || b.kind == Kind::array) {
+        const Container &small = a.kind == Kind::array ? a : b;
+        const Container &other = a.kind == Kind::array ? b : a;
+        std::vector<uint16_t> values;
+        for (uint16_t v : small.values) {
+            if (contains(other, v)) {
+                values.push_back(v);
+            }
+        }
+        return from_values(std::move(values));
+    }
+    return combine(
+        a, b,
+        [](auto... args) { return std::set_intersection(args...); },
+        [](uint64_t x, uint64_t y) { return x & y; });
+}
+
+Container unite(const Container &a, const Container &b) {
+    return combine(
+        a, b, [](auto... args) { return std::set_union(args...); },
+        [](uint64_t x, uint64_t y) { return x | y; });
+}
+
+Container symmetric_difference(const Container &a, const Container &b) {
+    return combine(
+        a, b,
+        [](auto... args) { return std::set_symmetric_difference(args...); },
+        [](uint64_t x, uint64_t y) { return x ^ y; });
+}
+
+bool equal(const Container &a, const Container &b) {
+    if (a.cardinality != b.cardinality) {
+        return false;
+    }
+    if (a.kind == b.kind) {
+        return a.values == b.values && a.words == b.words;
+    }
+    Words x;
+    Words y;
+    to_words(a, x);
+    to_words(b, y);
+    return x == y;
+}
+
+/*!
+ * Call `f(i, j)` for every key that `a[i]` and `b[j]` share, in order. The
+ * shorter list is walked and the longer one searched, so the cost follows
+ * the smaller operand.
+ */
+template <class F>
+void for_common_keys(const std::vector<uint16_t> &a,
+                     const std::vector<uint16_t> &b, F f) {
+    const bool a_shorter = a.size() <= b.size();
+    const std::vector<uint16_t> &shorter = a_shorter ? a : b;
+    const std::vector<uint16_t> &longer = a_shorter ? b : a;
+    auto from = longer.begin();
+    for (size_t i = 0; i < shorter.size() && from != longer.end(); i++) {
+        from = std::lower_bound(from, longer.end(), shorter[i]);
+        if (from != longer.end() && *from == shorter[i]) {
+            size_t j = from - longer.begin();
+            a_shorter ? f(i, j) : f(j, i);
+        }
+    }
+}
+
+} // namespace
+
+RoaringBitmap::RoaringBitmap(const BitArray &bits) {
+    if (bits.size() > (size_t{1} << 32)) {
+        throw std::invalid_argument("BitArray is too large for RoaringBitmap");
+    }
+    const uint64_t *data = bits.data();
+    for (size_t first = 0; first < bits.num_words(); first += chunk_words) {
+        size_t n = std::min(chunk_words, bits.num_words() - first);
+        if (std::all_of(data + first, data + first + n,
+                        [](uint64_t word) { return word == 0; })) {
+            continue;
+        }
+        Words words{};
+        std::copy(data + first, data + first + n, words.begin());
+        keys.push_back(static_cast<uint16_t>(first / chunk_words));
+        containers.push_back(from_words(words));
+    }
+}
+
+BitArray RoaringBitmap::to_bit_array(size_t num_bits) const {
+    BitArray bits(num_bits);
+    uint64_t *data = bits.data();
+    Words words;
+    for (size_t i = 0; i < keys.size(); i++) {
+        size_t first = keys[i] * chunk_words;
+        if (first >= bits.num_words()) {
+            break;
+        }
+        to_words(containers[i], words);
+        size_t n = std::min(chunk_words, bits.num_words() - first);
+        std::copy(words.begin(), words.begin() + n, data + first);
+    }
+    if (num_bits % 64 != 0) {
+        data[bits.num_words() - 1] &= (uint64_t{1} << (num_bits % 64)) - 1;
+    }
+    return bits;
+}
+
+BitArray RoaringBitmap::to_bit_array() const {
+    if (keys.empty()) {
+        return BitArray();
+    }
+    Words words;
+    to_words(containers.back(), words);
+    size_t last = chunk_words;
+    while (words[last - 1] == 0) {
+        last--;
+    }
+    size_t top = 64 * last - std::countl_zero(words[last - 1]);
+    return to_bit_array(size_t{keys.back()} * chunk_bits + top);
+}
+
+RoaringBitmap &RoaringBitmap::set(uint32_t n, bool val) {
+    if (!val) {
+        return reset(n);
+    }
+    uint16_t key = n >> 16;
+    size_t i = find_key(key);
+    if (i == keys.size() || keys[i] != key) {
+        keys.insert(keys.begin() + i, key);
+        containers.insert(containers.begin() + i, Container{});
+    }
+    add(containers[i], n & 0xFFFF);
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::set_range(uint32_t pos, uint64_t len) {
+    uint64_t end = uint64_t{pos} + len;
+    if (end > (uint64_t{1} << 32)) {
+        throw std::out_of_range("Index out of range");
+    }
+    for (uint64_t first = pos; first < end;) {
+        uint16_t key = first >> 16;
+        uint64_t last = std::min(end, (uint64_t{key} + 1) * chunk_bits) - 1;
+        size_t i = find_key(key);
+        if (i == keys.size() || keys[i] != key) {
+            keys.insert(keys.begin() + i, key);
+            containers.insert(containers.begin() + i, Container{});
+        }
+        if ((first & 0xFFFF) == 0 && (last & 0xFFFF) == 0xFFFF) {
+            containers[i] = Container{Kind::run, chunk_bits, {0, 0xFFFF}};
+        } else {
+            Words words;
+            to_words(containers[i], words);
+            set_bits(words.data(), first & 0xFFFF, last & 0xFFFF);
+            containers[i] = from_words(words);
+        }
+        first = last + 1;
+    }
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::reset(uint32_t n) {
+    uint16_t key = n >> 16;
+    size_t i = find_key(key);
+    if (i < keys.size() && keys[i] == key) {
+        remove(containers[i], n & 0xFFFF);
+        if (containers[i].cardinality == 0) {
+            keys.erase(keys.begin() + i);
+            containers.erase(containers.begin() + i);
+        }
+    }
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::reset() {
+    keys.clear();
+    containers.clear();
+    return *this;
+}
+
+bool RoaringBitmap::operator[](uint32_t n) const {
+    uint16_t key = n >> 16;
+    size_t i = find_key(key);
+    return i < keys.size() && keys[i] == key &&
+           contains(containers[i], n & 0xFFFF);
+}
+
+size_t RoaringBitmap::count() const {
+    size_t cnt = 0;
+    for (const auto &c : containers) {
+        cnt += c.cardinality;
+    }
+    return cnt;
+}
+
+bool RoaringBitmap::any() const { return !keys.empty(); }
+
+bool RoaringBitmap::none() const { return keys.empty(); }
+
+void RoaringBitmap::run_optimize() {
+    for (auto &c : containers) {
+        optimize(c);
+    }
+}
+
+size_t RoaringBitmap::memory_usage() const {
+    size_t bytes = sizeof(*this) + keys.capacity() * sizeof(uint16_t) +
+                   containers.capacity() * sizeof(Container);
+    for (const auto &c : containers) {
+        bytes += c.values.capacity() * sizeof(uint16_t) +
+                 c.words.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+RoaringBitmap &RoaringBitmap::operator&=(const RoaringBitmap &b) {
+    // The kept containers move down over ones already visited.
+    size_t out = 0;
+    for_common_keys(keys, b.keys, [&](size_t i, size_t j) {
+        Container c = intersect(containers[i], b.containers[j]);
+        if (c.cardinality != 0) {
+            keys[out] = keys[i];
+            containers[out] = std::move(c);
+            out++;
+        }
+    });
+    keys.resize(out);
+    containers.resize(out);
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::operator|=(const RoaringBitmap &b) {
+    *this = *this | b;
+    return *this;
+}
+
+RoaringBitmap &RoaringBitmap::operator^=(const RoaringBitmap &b) {
+    *this = *this ^ b;
+    return *this;
+}
+
+size_t RoaringBitmap::find_key(uint16_t key) const {
+    return std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+}
+
+bool operator==(const RoaringBitmap &a, const RoaringBitmap &b) {
+    if (a.keys != b.keys) {
+        return false;
+    }
+    for (size_t i = 0; i < a.containers.size(); i++) {
+        if (!equal(a.containers[i], b.containers[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator!=(const RoaringBitmap &a, const RoaringBitmap &b) {
+    return !(a == b);
+}
+
+RoaringBitmap operator&(const RoaringBitmap &a, const RoaringBitmap &b) {
+    // Only the containers of shared keys are read, so `huge & tiny` costs
+    // about as much as `tiny`.
+    RoaringBitmap res;
+    for_common_keys(a.keys, b.keys, [&](size_t i, size_t j) {
+        Container c = intersect(a.containers[i], b.containers[j]);
+        if (c.cardinality != 0) {
+            res.keys.push_back(a.keys[i]);
+            res.containers.push_back(std::move(c));
+        }
+    });
+    return res;
+}
+
+RoaringBitmap operator|(const RoaringBitmap &a, const RoaringBitmap &b) {
+    RoaringBitmap res;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.keys.size() || j < b.keys.size()) {
+        if (j == b.keys.size() ||
+            (i < a.keys.size() && a.keys[i] < b.keys[j])) {
+            res.keys.push_back(a.keys[i]);
+            res.containers.push_back(a.containers[i++]);
+        } else if (i == a.keys.size() || b.keys[j] < a.keys[i]) {
+            res.keys.push_back(b.keys[j]);
+            res.containers.push_back(b.containers[j++]);
+        } else {
+            res.keys.push_back(a.keys[i]);
+            res.containers.push_back(
+                unite(a.containers[i++], b.containers[j++]));
+        }
+    }
+    return res;
+}
+
+RoaringBitmap operator^(const RoaringBitmap &a, const RoaringBitmap &b) {
+    RoaringBitmap res;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.keys.size() || j < b.keys.size()) {
+        if (j == b.keys.size() ||
+            (i < a.keys.size() && a.keys[i] < b.keys[j])) {
+            res.keys.push_back(a.keys[i]);
+            res.containers.push_back(a.containers[i++]);
+        } else if (i == a.keys.size() || b.keys[j] < a.keys[i]) {
+            res.keys.push_back(b.keys[j]);
+            res.containers.push_back(b.containers[j++]);
+        } else {
+            Container c =
+                symmetric_difference(a.containers[i++], b.containers[j++]);
+            if (c.cardinality != 0) {
+                res.keys.push_back(a.keys[i - 1]);
+                res.containers.push_back(std::move(c));
+            }
+        }
+    }
+    return res;
+}
@@ -0,0 +1,76 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 1; i < threads; i++) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t n, const std::function<void(size_t)> &job) {
+    std::lock_guard run_lock(run_mutex);
+    {
+        std::unique_lock lock(mutex);
+        // A worker that woke too late for the previous job may still be
+        // looking at it.
+        done.wait(lock, [this] { return active == 0; });
+        task = &job;
+        num_tasks = n;
+        next.store(0, std::memory_order_relaxed);
+        generation++;
+    }
+    wake.notify_all();
+    drain(job, n);
+
+    std::unique_lock lock(mutex);
+    done.wait(lock, [this] { return active == 0; });
+    task = nullptr;
+    num_tasks = 0;
+}
+
+size_t ThreadPool::size() const { return workers.size() + 1; }
+
+void ThreadPool::work() {
+    uint64_t seen = 0;
+    std::unique_lock lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stop || generation != seen; });
+        if (stop) {
+            return;
+        }
+        seen = generation;
+        if (task == nullptr) {
+            continue;
+        }
+        const std::function<void(size_t)> &job = *task;
+        size_t n = num_tasks;
+        active++;
+        lock.unlock();
+        drain(job, n);
+        lock.lock();
+        if (--active == 0) {
+            done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::drain(const std::function<void(size_t)> &job, size_t n) {
+    for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) {
+        job(i);
+    }
+}
@@ -0,0 +1,104 @@
+#include "word_buffer.h"
+
+#include <algorithm>
+#include <utility>
+
+WordBuffer::WordBuffer(size_t n) {
+    reallocate(n);
+    std::fill(words, words + n, 0);
+    num_words = n;
+}
+
+WordBuffer::WordBuffer(const WordBuffer &b) {
+    if (b.words == nullptr) {
+        return;
+    }
+    if (bit_cow::enabled()) {
+        words = static_cast<uint64_t *>(bit_cow::share(b.words));
+        num_words = b.num_words;
+        capacity_words = b.capacity_words;
+        return;
+    }
+    reallocate(b.num_words);
+    std::copy(b.begin(), b.end(), words);
+    num_words = b.num_words;
+}
+
+WordBuffer::WordBuffer(WordBuffer &&b) noexcept
+    : words(std::exchange(b.words, nullptr)),
+      num_words(std::exchange(b.num_words, 0)),
+      capacity_words(std::exchange(b.capacity_words, 0)) {}
+
+WordBuffer &WordBuffer::operator=(const WordBuffer &b) {
+    if (this != &b) {
+        WordBuffer temp(b);
+        swap(temp);
+    }
+    return *this;
+}
+
+WordBuffer &WordBuffer::operator=(WordBuffer &&b) noexcept {
+    if (this != &b) {
+        WordBuffer temp(std::move(b));
+        swap(temp);
+    }
+    return *this;
+}
+
+WordBuffer::~WordBuffer() { bit_cow::release(words); }
+
+void WordBuffer::swap(WordBuffer &b) noexcept {
+    std::swap(words, b.words);
+    std::swap(num_words, b.num_words);
+    std::swap(capacity_words, b.capacity_words);
+}
+
+void WordBuffer::clear() {
+    if (words != nullptr && bit_cow::shared(words)) {
+        bit_cow::release(std::exchange(words, nullptr));
+        capacity_words = 0;
+    }
+    num_words = 0;
+}
+
+void WordBuffer::resize(size_t n, uint64_t value) {
+    if (n <= num_words) {
+        num_words = n;
+        return;
+    }
+    if (n > capacity_words) {
+        // Grow geometrically so that a run of push_back calls is linear.
+        reallocate(std::max(n, 2 * capacity_words));
+    } else {
+        detach();
+    }
+    std::fill(words + num_words, words + n, value);
+    num_words = n;
+}
+
+void WordBuffer::reserve(size_t n) {
+    if (n > capacity_words) {
+        reallocate(n);
+    }
+}
+
+void WordBuffer::shrink_to_fit() {
+    if (capacity_words > num_words) {
+        reallocate(num_words);
+    }
+}
+
+void WordBuffer::push_back(uint64_t w) { resize(num_words + 1, w); }
+
+void WordBuffer::reallocate(size_t new_capacity) {
+    uint64_t *new_words = nullptr;
+    if (new_capacity != 0) {
+        new_words = static_cast<uint64_t *>(
+            bit_cow::allocate(new_capacity * sizeof(uint64_t)));
+        std::copy(words, words + std::min(num_words, new_capacity), new_words);
+    }
+    bit_cow::release(words);
+    words = new_words;
+    capacity_words = new_capacity;
+    num_words = std::min(num_words, new_capacity);
+}
@@ -0,0 +1,91 @@
+#include "atomic_bit_array.h"
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+// Тест однопоточных операций
+TEST(AtomicBitArrayTest, SetResetAndTest) {
+    AtomicBitArray bits(130);
+    EXPECT_EQ(bits.size(), 130);
+    EXPECT_EQ(bits.num_words(), 3);
+    EXPECT_EQ(bits.count(), 0);
+
+    bits.set(0);
+    bits.set(129, std::memory_order_relaxed);
+    EXPECT_TRUE(bits.test(0));
+    EXPECT_TRUE(bits.test(129));
+    EXPECT_FALSE(bits.test(64));
+    EXPECT_FALSE(bits.test_and_set(64));
+    EXPECT_TRUE(bits.test_and_set(64));
+    EXPECT_EQ(bits.count(), 3);
+
+    bits.reset(0);
+    EXPECT_FALSE(bits.test(0));
+    EXPECT_THROW(bits.set(130), std::invalid_argument);
+
+    bits.reset();
+    EXPECT_EQ(bits.count(), 0);
+}
+
+// Тест операций над словами целиком
+TEST(AtomicBitArrayTest, WordOperations) {
+    AtomicBitArray bits(70);
+    EXPECT_EQ(bits.fetch_or(0, 0xF0), 0);
+    EXPECT_EQ(bits.fetch_or(0, 0x0F), 0xF0);
+    EXPECT_EQ(bits.fetch_and(0, 0x3C), 0xFF);
+    EXPECT_EQ(bits.load_word(0), 0x3C);
+
+    // Биты за пределами размера не устанавливаются
+    bits.fetch_or(1, ~uint64_t{0});
+    EXPECT_EQ(bits.load_word(1), 0x3F);
+    EXPECT_EQ(bits.count(), 10);
+    EXPECT_THROW(bits.fetch_or(2, 1), std::invalid_argument);
+}
+
+// Тест преобразования в BitArray и обратно
+TEST(AtomicBitArrayTest, Snapshot) {
+    BitArray bits(200);
+    bits.set_range(10, 100);
+    AtomicBitArray atomic_bits(bits);
+    EXPECT_EQ(atomic_bits.snapshot(), bits);
+
+    atomic_bits.set(150);
+    bits.set(150);
+    EXPECT_EQ(atomic_bits.snapshot(), bits);
+
+    AtomicBitArray moved = std::move(atomic_bits);
+    EXPECT_EQ(moved.count(), 101);
+    EXPECT_EQ(atomic_bits.size(), 0);
+}
+
+// Тест одновременной пометки из нескольких потоков
+TEST(AtomicBitArrayTest, ConcurrentMarking) {
+    const size_t size = 100000;
+    const size_t num_threads = 8;
+    AtomicBitArray bits(size);
+    std::vector<size_t> won(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            // Все потоки пытаются пометить все биты, начиная с разных мест
+            for (size_t k = 0; k < size; k++) {
+                size_t i = (k + t * size / num_threads) % size;
+                if (!bits.test_and_set(i, std::memory_order_relaxed)) {
+                    won[t]++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    size_t total = 0;
+    for (size_t w : won) {
+        total += w;
+    }
+    EXPECT_EQ(total, size);
+    EXPECT_EQ(bits.count(), size);
+    EXPECT_EQ(bits.snapshot().count(), size);
+}
@@ -0,0 +1,120 @@
+#include "bit_alloc.h"
+#include "bit_array.h"
+#include "bit_cow.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+
+size_t allocated = 0;
+size_t freed = 0;
+
+void *counting_allocate(size_t bytes) {
+    allocated += bytes;
+    return bit_alloc::aligned().allocate(bytes);
+}
+
+void counting_deallocate(void *p, size_t bytes) {
+    freed += bytes;
+    bit_alloc::aligned().deallocate(p, bytes);
+}
+
+constexpr bit_alloc::Allocator counting{"counting", counting_allocate,
+                                        counting_deallocate};
+
+bool aligned(const void *p) {
+    return reinterpret_cast<uintptr_t>(p) % bit_alloc::alignment == 0;
+}
+
+} // namespace
+
+// Тест выравнивания и работы массивов с каждым распределителем
+TEST(BitAlloc, Allocators) {
+    const bit_alloc::Allocator *allocators[] = {
+        &bit_alloc::aligned(), &bit_alloc::transparent_huge_pages(),
+        &bit_alloc::huge_pages()};
+    // Массив в 4 Мбайт выделяется отображением больших страниц
+    size_t sizes[] = {1, 100, 1000, size_t{32} << 20};
+    for (const bit_alloc::Allocator *allocator : allocators) {
+        bit_alloc::use(*allocator);
+        EXPECT_EQ(&bit_alloc::active(), allocator);
+        for (size_t size : sizes) {
+            BitArray a(size);
+            EXPECT_TRUE(aligned(a.data())) << allocator->name;
+            a.set(0).set(size / 2).set(size - 1);
+            BitArray b = a;
+            EXPECT_TRUE(aligned(b.data()));
+            EXPECT_EQ(a, b);
+            b.resize(size + 1000, true);
+            EXPECT_EQ(b.count(), a.count() + 1000);
+            EXPECT_TRUE(aligned(b.data()));
+        }
+    }
+    bit_alloc::use(bit_alloc::aligned());
+}
+
+// Тест собственного распределителя
+TEST(BitAlloc, Custom) {
+    allocated = 0;
+    freed = 0;
+    bit_alloc::use(counting);
+    {
+        BitArray a(10000);
+        a.set(9999);
+        EXPECT_GE(allocated, 10000 / 8);
+        // Распределитель меняется, но блок освобождается тем, кто его выделил
+        bit_alloc::use(bit_alloc::aligned());
+        BitArray b = a;
+        size_t count = allocated;
+        b.push_back(true);
+        EXPECT_EQ(allocated, count);
+        EXPECT_EQ(freed, 0);
+    }
+    EXPECT_EQ(freed, allocated);
+}
+
+// Тест общего блока при копировании при записи
+TEST(BitAlloc, CopyOnWrite) {
+    allocated = 0;
+    freed = 0;
+    bit_alloc::use(counting);
+    bit_cow::enable();
+    {
+        BitArray a(size_t{20} << 20);
+        size_t count = allocated;
+        BitArray b = a;
+        EXPECT_EQ(allocated, count);
+        bit_alloc::use(bit_alloc::transparent_huge_pages());
+        b.set(1);
+        EXPECT_TRUE(aligned(b.data()));
+        EXPECT_EQ(allocated, count);
+        EXPECT_FALSE(a[1]);
+    }
+    bit_cow::disable();
+    bit_alloc::use(bit_alloc::aligned());
+    EXPECT_EQ(freed, allocated);
+}
+
+// Тест блока из целых больших страниц с заголовком перед ними
+TEST(BitAlloc, HeaderBeforeHugePages) {
+    const bit_alloc::Allocator *allocators[] = {
+        &bit_alloc::transparent_huge_pages(), &bit_alloc::huge_pages()};
+    size_t bytes = bit_alloc::huge_page_size + bit_alloc::alignment;
+    for (const bit_alloc::Allocator *allocator : allocators) {
+        auto *p = static_cast<unsigned char *>(allocator->allocate(bytes));
+        EXPECT_TRUE(aligned(p)) << allocator->name;
+        p[0] = 1;
+        p[bytes - 1] = 1;
+        allocator->deallocate(p, bytes);
+
+        // Данные массива в 2 Мбайт начинаются на границе большой страницы
+        bit_alloc::use(*allocator);
+        BitArray a(bit_alloc::huge_page_size * 8);
+        bit_alloc::use(bit_alloc::aligned());
+        auto data = reinterpret_cast<uintptr_t>(a.data());
+        EXPECT_EQ(data % bit_alloc::huge_page_size, 0) << allocator->name;
+        a.set(0).set(a.size() - 1);
+        EXPECT_EQ(a.count(), 2);
+    }
+}
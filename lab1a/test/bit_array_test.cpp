@@ -1,6 +1,16 @@
 #include "bit_array.h"
+#include "bit_cow.h"
+#include "bit_matrix.h"
+#include "bit_span.h"
+#include "bit_text.h"
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
 // Тест конструктора и начальной инициализации
 TEST(BitArrayTest, ConstructorDefault) {
     BitArray bits;
@@ -149,3 +159,459 @@ TEST(BitArrayTest, InequalityOperator) {
     BitArray bits2(5, 0b11011);
     EXPECT_TRUE(bits1 != bits2);
 }
+
+// Тест resize с заполнением единицами через границу слова
+TEST(BitArrayTest, ResizeAcrossWordBoundary) {
+    BitArray bits(60, 0b1);
+    bits.resize(130, true);
+    EXPECT_EQ(bits.size(), 130);
+    EXPECT_EQ(bits.count(), 71);
+    EXPECT_FALSE(bits[59]);
+    EXPECT_TRUE(bits[60]);
+    EXPECT_TRUE(bits[129]);
+
+    bits.resize(64);
+    EXPECT_EQ(bits.count(), 5);
+    bits.resize(128);
+    EXPECT_EQ(bits.count(), 5);
+}
+
+// Тест побитовых операций над массивами разной длины
+TEST(BitArrayTest, BitwiseDifferentSizes) {
+    BitArray bits1(100);
+    bits1.set();
+    BitArray bits2(70, 0b1);
+
+    BitArray result = bits1 & bits2;
+    EXPECT_EQ(result.size(), 100);
+    EXPECT_EQ(result.count(), 31);
+
+    bits2.set();
+    result = bits2 | bits1;
+    EXPECT_EQ(result.count(), 70);
+    result = bits2 ^ bits1;
+    EXPECT_TRUE(result.none());
+}
+
+// Тест сдвигов через границы слов
+TEST(BitArrayTest, ShiftAcrossWords) {
+    BitArray bits(200, 0b11);
+    bits <<= 130;
+    EXPECT_EQ(bits.count(), 2);
+    EXPECT_TRUE(bits[130]);
+    EXPECT_TRUE(bits[131]);
+
+    bits <<= 69;
+    EXPECT_EQ(bits.count(), 1);
+    EXPECT_TRUE(bits[199]);
+
+    bits >>= 199;
+    EXPECT_EQ(bits, BitArray(200, 1));
+    EXPECT_TRUE((bits >> 1).none());
+}
+
+// Тест инверсии и подсчета для многословного массива
+TEST(BitArrayTest, InvertLargeArray) {
+    BitArray bits(1000);
+    bits.set(0).set(999);
+    BitArray inverted = ~bits;
+    EXPECT_EQ(inverted.count(), 998);
+    EXPECT_EQ(inverted.size(), 1000);
+    EXPECT_EQ((~inverted), bits);
+}
+
+// Тест push_back и pop_back
+TEST(BitArrayTest, PushPopBack) {
+    BitArray bits;
+    for (size_t i = 0; i < 130; i++) {
+        bits.push_back(i % 3 == 0);
+    }
+    EXPECT_EQ(bits.size(), 130);
+    EXPECT_EQ(bits.count(), 44);
+    for (size_t i = 0; i < 66; i++) {
+        bits.pop_back();
+    }
+    EXPECT_EQ(bits.size(), 64);
+    EXPECT_EQ(bits.count(), 22);
+}
+
+// Тест сдвигов против побитового эталона
+TEST(BitArrayTest, ShiftMatchesBitByBit) {
+    for (size_t size : {1, 7, 8, 9, 63, 64, 65, 200}) {
+        BitArray bits(size);
+        for (size_t i = 0; i < size; i += 3) {
+            bits.set(i);
+        }
+        for (size_t n = 0; n <= size + 1; n++) {
+            BitArray left = bits << n;
+            BitArray right = bits >> n;
+            for (size_t i = 0; i < size; i++) {
+                ASSERT_EQ(left[i], i >= n && bits[i - n]);
+                ASSERT_EQ(right[i], i + n < size && bits[i + n]);
+            }
+        }
+    }
+}
+
+// Тест поиска установленных битов
+TEST(BitArrayTest, FindSetBits) {
+    BitArray bits(300);
+    EXPECT_EQ(bits.find_first(), BitArray::npos);
+    EXPECT_EQ(bits.find_last(), BitArray::npos);
+
+    bits.set(5).set(64).set(299);
+    EXPECT_EQ(bits.find_first(), 5);
+    EXPECT_EQ(bits.find_next(5), 64);
+    EXPECT_EQ(bits.find_next(6), 64);
+    EXPECT_EQ(bits.find_next(64), 299);
+    EXPECT_EQ(bits.find_next(299), BitArray::npos);
+    EXPECT_EQ(bits.find_next(BitArray::npos), BitArray::npos);
+    EXPECT_EQ(bits.find_last(), 299);
+}
+
+// Тест обхода установленных битов итератором и for_each_set
+TEST(BitArrayTest, IterateSetBits) {
+    BitArray bits(1000);
+    std::vector<size_t> expected;
+    for (size_t i = 3; i < 1000; i += 97) {
+        bits.set(i);
+        expected.push_back(i);
+    }
+
+    std::vector<size_t> iterated(bits.set_bits().begin(),
+                                 bits.set_bits().end());
+    EXPECT_EQ(iterated, expected);
+
+    std::vector<size_t> visited;
+    bits.for_each_set([&](size_t i) { visited.push_back(i); });
+    EXPECT_EQ(visited, expected);
+
+    BitArray empty(500);
+    EXPECT_EQ(empty.set_bits().begin(), empty.set_bits().end());
+}
+
+// Тест операций над диапазоном битов
+TEST(BitArrayTest, RangeOperations) {
+    BitArray bits(300);
+    bits.set_range(10, 200);
+    EXPECT_EQ(bits.count(), 200);
+    EXPECT_FALSE(bits[9]);
+    EXPECT_TRUE(bits[10]);
+    EXPECT_TRUE(bits[209]);
+    EXPECT_FALSE(bits[210]);
+    EXPECT_EQ(bits.count_range(0, 64), 54);
+    EXPECT_EQ(bits.count_range(100, 150), 110);
+
+    bits.reset_range(60, 10);
+    EXPECT_EQ(bits.count(), 190);
+    EXPECT_TRUE(bits.none_range(60, 10));
+    EXPECT_TRUE(bits.any_range(59, 2));
+
+    bits.flip_range(0, 300);
+    EXPECT_EQ(bits.count(), 110);
+    EXPECT_TRUE(bits.none_range(70, 140));
+    EXPECT_TRUE(bits.any_range(299, 1));
+
+    bits.set_range(3, 4).set_range(299, 0, false);
+    EXPECT_EQ(bits.count_range(0, 10), 10);
+}
+
+// Тест проверки границ диапазона
+TEST(BitArrayTest, RangeOutOfBounds) {
+    BitArray bits(100);
+    EXPECT_NO_THROW(bits.set_range(100, 0));
+    EXPECT_THROW(bits.set_range(90, 11), std::invalid_argument);
+    EXPECT_THROW(bits.count_range(101, 0), std::invalid_argument);
+    EXPECT_THROW(bits.any_range(1, BitArray::npos), std::invalid_argument);
+}
+
+// Тест составного выражения без промежуточных массивов
+TEST(BitArrayTest, FusedExpression) {
+    BitArray a(130, 0b1100);
+    BitArray b(130, 0b1010);
+    BitArray c(130, 0b0110);
+    BitArray d(130, 0b0011);
+    a.set(129);
+    b.set(129);
+
+    BitArray result = (a & b) | (c ^ d);
+    EXPECT_EQ(result.size(), 130);
+    EXPECT_EQ(result.count(), 4);
+    EXPECT_TRUE(result[129]);
+    EXPECT_EQ((a & b).count(), 2);
+    EXPECT_TRUE((a ^ a).none());
+    EXPECT_EQ((~(a | b)).count(), 126);
+    EXPECT_EQ(BitArray(~a & b), BitArray(130, 0b0010));
+}
+
+// Тест присваивания выражения, которое читает целевой массив
+TEST(BitArrayTest, ExpressionAliasing) {
+    BitArray a(70, 0b1100);
+    BitArray b(70, 0b1010);
+    a = a & b;
+    EXPECT_EQ(a, BitArray(70, 0b1000));
+
+    a |= b ^ BitArray(70, 0b1);
+    EXPECT_EQ(a, BitArray(70, 0b1011));
+
+    BitArray longer(200);
+    longer.set();
+    a = longer & a;
+    EXPECT_EQ(a.size(), 200);
+    EXPECT_EQ(a.count(), 133);
+}
+
+// Тест перемещения
+TEST(BitArrayTest, MoveSemantics) {
+    static_assert(std::is_nothrow_move_constructible_v<BitArray>);
+    static_assert(std::is_nothrow_move_assignable_v<BitArray>);
+
+    BitArray large(1000, 0b11);
+    BitArray moved(std::move(large));
+    EXPECT_EQ(moved.count(), 2);
+    EXPECT_EQ(moved.size(), 1000);
+
+    BitArray small(10, 0b101);
+    moved = std::move(small);
+    EXPECT_EQ(moved.to_string(), "0000000101");
+}
+
+// Тест reserve, capacity и shrink_to_fit
+TEST(BitArrayTest, CapacityAndGrowth) {
+    BitArray bits;
+    bits.reserve(1000);
+    size_t reserved = bits.capacity();
+    EXPECT_GE(reserved, 1000);
+    for (size_t i = 0; i < 1000; i++) {
+        bits.push_back(i % 2 == 0);
+    }
+    EXPECT_EQ(bits.capacity(), reserved);
+    EXPECT_EQ(bits.count(), 500);
+
+    for (size_t i = 0; i < 100000; i++) {
+        bits.push_back(true);
+    }
+    EXPECT_GE(bits.capacity(), bits.size());
+    EXPECT_LE(bits.capacity(), 2 * bits.size() + 64);
+
+    bits.resize(10);
+    bits.shrink_to_fit();
+    EXPECT_LT(bits.capacity(), 1000);
+    EXPECT_EQ(bits.to_string(), "0101010101");
+
+    bits.clear();
+    EXPECT_TRUE(bits.empty());
+    bits.push_back(true);
+    EXPECT_EQ(bits.to_string(), "1");
+}
+
+// Тест состояния массива после перемещения
+TEST(BitArrayTest, MovedFromIsEmpty) {
+    BitArray bits(100, 0b1);
+    BitArray moved = std::move(bits);
+    EXPECT_TRUE(bits.empty());
+    EXPECT_EQ(bits.count(), 0);
+    bits.push_back(true);
+    EXPECT_EQ(bits.to_string(), "1");
+}
+
+// Тест преобразования в строку и обратно
+TEST(BitArrayTest, StringRoundTrip) {
+    EXPECT_EQ(BitArray().to_string(), "");
+    EXPECT_EQ(BitArray::from_string("").size(), 0);
+    EXPECT_EQ(BitArray::from_string("0110").to_string(), "0110");
+    EXPECT_EQ(BitArray::from_string("100")[2], true);
+
+    BitArray bits(1000);
+    for (size_t i = 0; i < bits.size(); i += 3) {
+        bits.set(i);
+    }
+    std::string text = bits.to_string();
+    for (size_t i = 0; i < bits.size(); i++) {
+        ASSERT_EQ(text[bits.size() - 1 - i], bits[i] ? '1' : '0');
+    }
+    EXPECT_EQ(BitArray::from_string(text), bits);
+    EXPECT_EQ(BitArray::from_string(text.substr(5)).to_string(),
+              text.substr(5));
+
+    EXPECT_THROW(BitArray::from_string("0120"), std::invalid_argument);
+    EXPECT_THROW(BitArray::from_string(std::string(20, '1') + "x"),
+                 std::invalid_argument);
+}
+
+// Тест текстового, шестнадцатеричного и двоичного вывода в поток
+TEST(BitArrayTest, StreamFormats) {
+    BitArray bits = BitArray::from_string("1011001110001");
+    std::stringstream text;
+    text << bits << " " << std::hex << bits;
+    EXPECT_EQ(text.str(), "1011001110001 13:1671");
+
+    BitArray read_bits, read_hex;
+    text >> std::dec >> read_bits >> std::hex >> read_hex;
+    EXPECT_EQ(read_bits, bits);
+    EXPECT_EQ(read_hex, bits);
+
+    // Пустой массив записывается как "0:" и читается обратно в обоих видах
+    std::stringstream empty;
+    empty << BitArray() << " " << std::hex << BitArray();
+    EXPECT_EQ(empty.str(), "0: 0:");
+    BitArray empty_bits(5), empty_hex(5);
+    empty >> std::dec >> empty_bits >> std::hex >> empty_hex;
+    EXPECT_FALSE(empty.fail());
+    EXPECT_TRUE(empty_bits.empty());
+    EXPECT_TRUE(empty_hex.empty());
+
+    // Шестнадцатеричная запись без длины читается кратной 4 битам
+    std::stringstream unsized("1671");
+    unsized >> std::hex >> read_hex;
+    EXPECT_EQ(read_hex.to_string(), "0001011001110001");
+
+    // Длина, не совпадающая с цифрами или лишними битами, - ошибка
+    for (const char *token : {"12:1671", "15:f671", "3:8", "x:1", ":1", "2:4",
+                              "99999999999999999999999:1"}) {
+        std::stringstream in(token);
+        BitArray target = bits;
+        in >> std::hex >> target;
+        EXPECT_TRUE(in.fail()) << token;
+        EXPECT_EQ(target, bits) << token;
+    }
+    std::stringstream sized_text("3:101");
+    sized_text >> read_bits;
+    EXPECT_EQ(read_bits.to_string(), "101");
+
+    BitArray big(1000, 0xDEADBEEF);
+    big.set(999);
+    std::stringstream raw;
+    raw << bit_text::rawbits << big << BitArray();
+    EXPECT_EQ(raw.str().size(), 8 + 128 + 8);
+    BitArray read_big, read_empty(5);
+    raw >> bit_text::rawbits >> read_big >> read_empty;
+    EXPECT_EQ(read_big, big);
+    EXPECT_TRUE(read_empty.empty());
+
+    std::stringstream bad("x101");
+    bad >> read_bits;
+    EXPECT_TRUE(bad.fail());
+}
+
+// Тест двоичного ввода с неверным заголовком или обрезанными данными
+TEST(BitArrayTest, RawStreamRejectsBadInput) {
+    auto header = [](uint64_t num_bits) {
+        std::string res(8, '\0');
+        for (size_t i = 0; i < 8; i++) {
+            res[i] = static_cast<char>(num_bits >> (8 * i));
+        }
+        return res;
+    };
+    const BitArray original(10, 0b101);
+    for (uint64_t num_bits : {~uint64_t{0}, ~uint64_t{0} - 60,
+                              uint64_t{1} << 40, uint64_t{100}}) {
+        std::stringstream in(header(num_bits) + std::string(15, '\xFF'));
+        BitArray bits = original;
+        in >> bit_text::rawbits >> bits;
+        EXPECT_TRUE(in.fail()) << num_bits;
+        EXPECT_EQ(bits, original) << num_bits;
+    }
+
+    // Поток без позиционирования: обрезка видна только после чтения
+    struct Unseekable : std::stringbuf {
+        using std::stringbuf::stringbuf;
+        pos_type seekoff(off_type, std::ios_base::seekdir,
+                         std::ios_base::openmode) override {
+            return pos_type(off_type(-1));
+        }
+    };
+    Unseekable buf(header(100) + std::string(8, '\xFF'));
+    std::istream in(&buf);
+    BitArray bits = original;
+    in >> bit_text::rawbits >> bits;
+    EXPECT_TRUE(in.fail());
+    EXPECT_TRUE(bits.empty());
+
+    Unseekable whole(header(12) + std::string(8, '\xFF'));
+    std::istream whole_in(&whole);
+    whole_in >> bit_text::rawbits >> bits;
+    EXPECT_FALSE(whole_in.fail());
+    EXPECT_EQ(bits.count(), 12);
+}
+
+// Тест копирования при записи: изменение копии не меняет оригинал
+TEST(BitArrayTest, CopyOnWrite) {
+    BitArray original(300, 0xF0F0);
+    original.set(299);
+    const std::string text = original.to_string();
+    std::vector<std::function<void(BitArray &)>> mutations = {
+        [](BitArray &b) { b.set(1); },
+        [](BitArray &b) { b.reset(4); },
+        [](BitArray &b) { b.set(); },
+        [](BitArray &b) { b.reset(); },
+        [](BitArray &b) { b.resize(500, true); },
+        [](BitArray &b) { b.resize(10); },
+        [](BitArray &b) { b.push_back(true); },
+        [](BitArray &b) { b.pop_back(); },
+        [](BitArray &b) { b &= BitArray(300, 0xFF); },
+        [](BitArray &b) { b |= BitArray(300, 0xFF); },
+        [](BitArray &b) { b ^= BitArray(300, 0xFF); },
+        [](BitArray &b) { b <<= 3; },
+        [](BitArray &b) { b >>= 70; },
+        [](BitArray &b) { b.clear(); },
+        [](BitArray &b) { b.set_range(100, 100); },
+        [](BitArray &b) { b.flip_range(1, 200); },
+        [](BitArray &b) { b = b & BitArray(300, 0xFF); },
+        [](BitArray &b) { b.data()[0] = 1; },
+        [](BitArray &b) { BitSpan(b, 10, 20).set(); },
+        [](BitArray &b) { BitSpan(b).reset(299); },
+    };
+    for (size_t i = 0; i < mutations.size(); i++) {
+        BitArray plain = original;
+        mutations[i](plain);
+
+        bit_cow::enable();
+        BitArray copy = original;
+        bit_cow::disable();
+        EXPECT_EQ(std::as_const(copy).data(), std::as_const(original).data());
+        mutations[i](copy);
+        EXPECT_EQ(copy, plain) << "mutation " << i;
+        EXPECT_EQ(original.to_string(), text) << "mutation " << i;
+    }
+
+    // Строки и столбцы матрицы пишут в её общий блок
+    BitMatrix matrix(70, 70);
+    matrix.set(3, 5);
+    bit_cow::enable();
+    BitMatrix by_row = matrix;
+    BitMatrix by_column = matrix;
+    bit_cow::disable();
+    by_row.row(1).set();
+    by_column.column(2).set(69);
+    EXPECT_EQ(matrix.count(), 1);
+    EXPECT_EQ(by_row.count(), 71);
+    EXPECT_EQ(by_column.count(), 2);
+}
+
+// Тест изменения общих копий из разных потоков
+TEST(BitArrayTest, CopyOnWriteThreads) {
+    BitArray original(10000);
+    original.set(5000);
+    bit_cow::enable();
+    std::vector<std::thread> threads;
+    std::vector<BitArray> results(4);
+    for (size_t t = 0; t < results.size(); t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < 1000; i++) {
+                BitArray copy = original;
+                copy.set(t);
+                results[t] = copy;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    bit_cow::disable();
+    EXPECT_EQ(original.count(), 1);
+    for (size_t t = 0; t < results.size(); t++) {
+        EXPECT_EQ(results[t].count(), 2);
+        EXPECT_TRUE(results[t][t]);
+    }
+}
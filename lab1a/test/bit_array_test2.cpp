@@ -1,6 +1,14 @@
 #include "bit_array2.h"
+#include "bit_cow.h"
+#include "bit_text.h"
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
 // Тест конструктора и начальной инициализации
 TEST(BitArrayTest, ConstructorDefault) {
     BitArray bits;
@@ -71,6 +79,20 @@ TEST(BitArrayTest, BitwiseXOR) {
     EXPECT_EQ(result.to_string(), "0110");
 }
 
+// Тест оператора сдвига влево
+TEST(BitArrayTest, LeftShiftOperator) {
+    BitArray bits(4, 0b1010);
+    BitArray result = bits << 2;
+    EXPECT_EQ(result.to_string(), "1000");
+}
+
+// Тест оператора сдвига вправо
+TEST(BitArrayTest, RightShiftOperator) {
+    BitArray bits(4, 0b1010);
+    BitArray result = bits >> 2;
+    EXPECT_EQ(result.to_string(), "0010");
+}
+
 // Тест функции set
 TEST(BitArrayTest, SetBits) {
     BitArray bits(5);
@@ -135,3 +157,338 @@ TEST(BitArrayTest, InequalityOperator) {
     BitArray bits2(5, 0b11011);
     EXPECT_TRUE(bits1 != bits2);
 }
+
+// Тест того, что лишние биты последнего байта не влияют на результат
+TEST(BitArrayTest, UnusedBitsStayClear) {
+    BitArray bits(5, 0b11111);
+    EXPECT_FALSE((~bits).any());
+
+    BitArray all(5);
+    all.set();
+    EXPECT_EQ(all, bits);
+    EXPECT_EQ(all.count(), 5);
+
+    BitArray grown(5, 0b1);
+    grown.resize(12, true);
+    EXPECT_EQ(grown.to_string(), "111111100001");
+}
+
+// Тест побитовых операций над длинными массивами
+TEST(BitArrayTest, BitwiseLargeArrays) {
+    BitArray bits1(1000);
+    BitArray bits2(1000);
+    bits1.set();
+    bits2.set(3).set(998);
+    EXPECT_EQ((bits1 & bits2), bits2);
+    EXPECT_EQ((bits1 | bits2), bits1);
+    EXPECT_EQ((bits1 ^ bits2).count(), 998);
+    EXPECT_EQ(~bits1, BitArray(1000));
+}
+
+// Тест сдвигов против побитового эталона
+TEST(BitArrayTest, ShiftMatchesBitByBit) {
+    for (size_t size : {1, 7, 8, 9, 63, 64, 65, 200}) {
+        BitArray bits(size);
+        for (size_t i = 0; i < size; i += 3) {
+            bits.set(i);
+        }
+        for (size_t n = 0; n <= size + 1; n++) {
+            BitArray left = bits << n;
+            BitArray right = bits >> n;
+            for (size_t i = 0; i < size; i++) {
+                ASSERT_EQ(left[i], i >= n && bits[i - n]);
+                ASSERT_EQ(right[i], i + n < size && bits[i + n]);
+            }
+        }
+    }
+}
+
+// Тест вычисления составного выражения за один проход
+TEST(BitArrayTest, FusedExpression) {
+    BitArray a(130, 0b1100);
+    BitArray b(130, 0b1010);
+    BitArray c(130, 0b0110);
+    BitArray d(130, 0b0011);
+    a.set(129);
+    b.set(129);
+
+    BitArray result = (a & b) | (c ^ d);
+    EXPECT_EQ(result.size(), 130);
+    EXPECT_EQ(result.count(), 4);
+    EXPECT_TRUE(result[129]);
+    EXPECT_EQ((a & b).count(), 2);
+    EXPECT_TRUE((a ^ a).none());
+    EXPECT_EQ((~(a | b)).count(), 126);
+    EXPECT_EQ(BitArray(~a & b), BitArray(130, 0b0010));
+
+    // Неполные слова и массивы во встроенном буфере
+    for (size_t size : {1, 13, 77, 128, 200}) {
+        BitArray x(size, 0x5A5A5A5A5A5A5A5Aull);
+        BitArray y(size, 0x0FF00FF00FF00FF0ull);
+        x.set(size - 1);
+        BitArray z = ~(x & y) ^ x;
+        size_t cnt = 0;
+        for (size_t i = 0; i < size; i++) {
+            bool bit = !(x[i] && y[i]) != x[i];
+            ASSERT_EQ(z[i], bit) << size << " " << i;
+            cnt += bit;
+        }
+        EXPECT_EQ(z.count(), cnt);
+        EXPECT_EQ((~(x & y) ^ x).count(), cnt);
+    }
+}
+
+// Тест присваивания выражения, которое читает целевой массив
+TEST(BitArrayTest, ExpressionAliasing) {
+    BitArray a(70, 0b1100);
+    BitArray b(70, 0b1010);
+    a = a & b;
+    EXPECT_EQ(a, BitArray(70, 0b1000));
+
+    a |= b ^ BitArray(70, 0b1);
+    EXPECT_EQ(a, BitArray(70, 0b1011));
+
+    BitArray longer(200);
+    longer.set();
+    a = longer & a;
+    EXPECT_EQ(a.size(), 200);
+    EXPECT_EQ(a.count(), 133);
+}
+
+// Тест переходов между встроенным буфером и кучей при resize
+TEST(BitArrayTest, ResizeAcrossInlineThreshold) {
+    BitArray bits(100, 0b101);
+    bits.set(99);
+    bits.resize(1000, true);
+    EXPECT_EQ(bits.count(), 903);
+    EXPECT_TRUE(bits[99]);
+
+    bits.resize(120);
+    EXPECT_EQ(bits.count(), 23);
+    bits.resize(8);
+    EXPECT_EQ(bits.to_string(), "00000101");
+    bits.resize(200);
+    EXPECT_EQ(bits.count(), 2);
+}
+
+// Тест копирования и обмена для маленьких и больших массивов
+TEST(BitArrayTest, CopySwapInlineAndHeap) {
+    BitArray small(16, 0xABCD);
+    BitArray large(500);
+    large.set(0).set(499);
+
+    BitArray small_copy(small);
+    BitArray large_copy(large);
+    small_copy.swap(large_copy);
+    EXPECT_EQ(small_copy, large);
+    EXPECT_EQ(large_copy, small);
+
+    BitArray other(8, 0xFF);
+    large_copy.swap(other);
+    EXPECT_EQ(large_copy.to_string(), "11111111");
+    EXPECT_EQ(other, small);
+
+    other = large;
+    EXPECT_EQ(other, large);
+    other = BitArray(3, 0b101);
+    EXPECT_EQ(other.to_string(), "101");
+
+    large.clear();
+    EXPECT_TRUE(large.empty());
+    large.push_back(true);
+    EXPECT_EQ(large.to_string(), "1");
+}
+
+// Тест перемещения
+TEST(BitArrayTest, MoveSemantics) {
+    static_assert(std::is_nothrow_move_constructible_v<BitArray>);
+    static_assert(std::is_nothrow_move_assignable_v<BitArray>);
+
+    BitArray large(1000, 0b11);
+    BitArray moved(std::move(large));
+    EXPECT_EQ(moved.count(), 2);
+    EXPECT_EQ(moved.size(), 1000);
+
+    BitArray small(10, 0b101);
+    moved = std::move(small);
+    EXPECT_EQ(moved.to_string(), "0000000101");
+}
+
+// Тест reserve, capacity и shrink_to_fit
+TEST(BitArrayTest, CapacityAndGrowth) {
+    BitArray bits;
+    bits.reserve(1000);
+    size_t reserved = bits.capacity();
+    EXPECT_GE(reserved, 1000);
+    for (size_t i = 0; i < 1000; i++) {
+        bits.push_back(i % 2 == 0);
+    }
+    EXPECT_EQ(bits.capacity(), reserved);
+    EXPECT_EQ(bits.count(), 500);
+
+    for (size_t i = 0; i < 100000; i++) {
+        bits.push_back(true);
+    }
+    EXPECT_GE(bits.capacity(), bits.size());
+    EXPECT_LE(bits.capacity(), 2 * bits.size() + 64);
+
+    bits.resize(10);
+    bits.shrink_to_fit();
+    EXPECT_LT(bits.capacity(), 1000);
+    EXPECT_EQ(bits.to_string(), "0101010101");
+
+    bits.clear();
+    EXPECT_TRUE(bits.empty());
+    bits.push_back(true);
+    EXPECT_EQ(bits.to_string(), "1");
+}
+
+// Тест состояния массива после перемещения
+TEST(BitArrayTest, MovedFromIsEmpty) {
+    BitArray bits(100, 0b1);
+    BitArray moved = std::move(bits);
+    EXPECT_TRUE(bits.empty());
+    EXPECT_EQ(bits.count(), 0);
+    bits.push_back(true);
+    EXPECT_EQ(bits.to_string(), "1");
+}
+
+// Тест преобразования в строку и обратно
+TEST(BitArrayTest, StringRoundTrip) {
+    EXPECT_EQ(BitArray().to_string(), "");
+    EXPECT_EQ(BitArray::from_string("").size(), 0);
+    EXPECT_EQ(BitArray::from_string("0110").to_string(), "0110");
+    EXPECT_EQ(BitArray::from_string("100")[2], true);
+
+    BitArray bits(1000);
+    for (size_t i = 0; i < bits.size(); i += 3) {
+        bits.set(i);
+    }
+    std::string text = bits.to_string();
+    for (size_t i = 0; i < bits.size(); i++) {
+        ASSERT_EQ(text[bits.size() - 1 - i], bits[i] ? '1' : '0');
+    }
+    EXPECT_EQ(BitArray::from_string(text), bits);
+    EXPECT_EQ(BitArray::from_string(text.substr(5)).to_string(),
+              text.substr(5));
+
+    EXPECT_THROW(BitArray::from_string("0120"), std::invalid_argument);
+    EXPECT_THROW(BitArray::from_string(std::string(20, '1') + "x"),
+                 std::invalid_argument);
+}
+
+// Тест текстового, шестнадцатеричного и двоичного вывода в поток
+TEST(BitArrayTest, StreamFormats) {
+    BitArray bits = BitArray::from_string("1011001110001");
+    std::stringstream text;
+    text << bits << " " << std::hex << bits;
+    EXPECT_EQ(text.str(), "1011001110001 13:1671");
+
+    BitArray read_bits, read_hex;
+    text >> std::dec >> read_bits >> std::hex >> read_hex;
+    EXPECT_EQ(read_bits, bits);
+    EXPECT_EQ(read_hex, bits);
+
+    // Пустой массив записывается как "0:" и читается обратно в обоих видах
+    std::stringstream empty;
+    empty << BitArray() << " " << std::hex << BitArray();
+    EXPECT_EQ(empty.str(), "0: 0:");
+    BitArray empty_bits(5), empty_hex(5);
+    empty >> std::dec >> empty_bits >> std::hex >> empty_hex;
+    EXPECT_FALSE(empty.fail());
+    EXPECT_TRUE(empty_bits.empty());
+    EXPECT_TRUE(empty_hex.empty());
+
+    // Шестнадцатеричная запись без длины читается кратной 4 битам
+    std::stringstream unsized("1671");
+    unsized >> std::hex >> read_hex;
+    EXPECT_EQ(read_hex.to_string(), "0001011001110001");
+
+    // Длина, не совпадающая с цифрами или лишними битами, - ошибка
+    for (const char *token : {"12:1671", "15:f671", "3:8", "x:1", ":1", "2:4",
+                              "99999999999999999999999:1"}) {
+        std::stringstream in(token);
+        BitArray target = bits;
+        in >> std::hex >> target;
+        EXPECT_TRUE(in.fail()) << token;
+        EXPECT_EQ(target, bits) << token;
+    }
+    std::stringstream sized_text("3:101");
+    sized_text >> read_bits;
+    EXPECT_EQ(read_bits.to_string(), "101");
+
+    BitArray big(1000, 0xDEADBEEF);
+    big.set(999);
+    std::stringstream raw;
+    raw << bit_text::rawbits << big << BitArray();
+    EXPECT_EQ(raw.str().size(), 8 + 128 + 8);
+    BitArray read_big, read_empty(5);
+    raw >> bit_text::rawbits >> read_big >> read_empty;
+    EXPECT_EQ(read_big, big);
+    EXPECT_TRUE(read_empty.empty());
+
+    std::stringstream bad("x101");
+    bad >> read_bits;
+    EXPECT_TRUE(bad.fail());
+}
+
+// Тест копирования при записи: изменение копии не меняет оригинал
+TEST(BitArrayTest, CopyOnWrite) {
+    BitArray original(300, 0xF0F0);
+    original.set(299);
+    const std::string text = original.to_string();
+    std::vector<std::function<void(BitArray &)>> mutations = {
+        [](BitArray &b) { b.set(1); },
+        [](BitArray &b) { b.reset(4); },
+        [](BitArray &b) { b.set(); },
+        [](BitArray &b) { b.reset(); },
+        [](BitArray &b) { b.resize(500, true); },
+        [](BitArray &b) { b.resize(10); },
+        [](BitArray &b) { b.push_back(true); },
+        [](BitArray &b) { b.pop_back(); },
+        [](BitArray &b) { b &= BitArray(300, 0xFF); },
+        [](BitArray &b) { b |= BitArray(300, 0xFF); },
+        [](BitArray &b) { b ^= BitArray(300, 0xFF); },
+        [](BitArray &b) { b <<= 3; },
+        [](BitArray &b) { b >>= 70; },
+        [](BitArray &b) { b.clear(); },
+    };
+    for (size_t i = 0; i < mutations.size(); i++) {
+        BitArray plain = original;
+        mutations[i](plain);
+
+        bit_cow::enable();
+        BitArray copy = original;
+        bit_cow::disable();
+        mutations[i](copy);
+        EXPECT_EQ(copy, plain) << "mutation " << i;
+        EXPECT_EQ(original.to_string(), text) << "mutation " << i;
+    }
+}
+
+// Тест изменения общих копий из разных потоков
+TEST(BitArrayTest, CopyOnWriteThreads) {
+    BitArray original(10000);
+    original.set(5000);
+    bit_cow::enable();
+    std::vector<std::thread> threads;
+    std::vector<BitArray> results(4);
+    for (size_t t = 0; t < results.size(); t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < 1000; i++) {
+                BitArray copy = original;
+                copy.set(t);
+                results[t] = copy;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    bit_cow::disable();
+    EXPECT_EQ(original.count(), 1);
+    for (size_t t = 0; t < results.size(); t++) {
+        EXPECT_EQ(results[t].count(), 2);
+        EXPECT_TRUE(results[t][t]);
+    }
+}
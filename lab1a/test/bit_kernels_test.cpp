@@ -0,0 +1,79 @@
+#include "bit_kernels.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+std::vector<unsigned char> pattern(size_t n, unsigned seed) {
+    std::vector<unsigned char> bytes(n);
+    for (size_t i = 0; i < n; i++) {
+        bytes[i] = static_cast<unsigned char>((i * 131 + seed) * 2654435761u);
+    }
+    return bytes;
+}
+
+} // namespace
+
+// Тест совпадения всех доступных ядер со скалярной реализацией
+TEST(BitKernelsTest, MatchScalar) {
+    auto kernels = bit_kernels::supported();
+    ASSERT_FALSE(kernels.empty());
+    const auto &scalar = *kernels.front();
+
+    for (size_t n : {0, 1, 7, 8, 15, 16, 31, 33, 64, 100, 257}) {
+        auto a = pattern(n, 1);
+        auto b = pattern(n, 2);
+        for (const auto *k : kernels) {
+            SCOPED_TRACE(k->name);
+            auto expected = a;
+            auto actual = a;
+
+            scalar.and_bytes(expected.data(), b.data(), n);
+            k->and_bytes(actual.data(), b.data(), n);
+            EXPECT_EQ(actual, expected);
+
+            scalar.or_bytes(expected.data(), b.data(), n);
+            k->or_bytes(actual.data(), b.data(), n);
+            EXPECT_EQ(actual, expected);
+
+            scalar.xor_bytes(expected.data(), b.data(), n);
+            k->xor_bytes(actual.data(), b.data(), n);
+            EXPECT_EQ(actual, expected);
+
+            scalar.not_bytes(expected.data(), a.data(), n);
+            k->not_bytes(actual.data(), a.data(), n);
+            EXPECT_EQ(actual, expected);
+
+            EXPECT_TRUE(k->equal_bytes(actual.data(), expected.data(), n));
+            EXPECT_EQ(k->count_bytes(a.data(), n),
+                      scalar.count_bytes(a.data(), n));
+            EXPECT_EQ(k->any_bytes(a.data(), n), n > 0);
+
+            EXPECT_EQ(k->and_count_bytes(a.data(), b.data(), n),
+                      scalar.and_count_bytes(a.data(), b.data(), n));
+            EXPECT_EQ(k->or_count_bytes(a.data(), b.data(), n),
+                      scalar.or_count_bytes(a.data(), b.data(), n));
+            EXPECT_EQ(k->xor_count_bytes(a.data(), b.data(), n),
+                      scalar.xor_count_bytes(a.data(), b.data(), n));
+            size_t or_count = 0;
+            EXPECT_EQ(k->and_or_count_bytes(a.data(), b.data(), n, &or_count),
+                      scalar.and_count_bytes(a.data(), b.data(), n));
+            EXPECT_EQ(or_count, scalar.or_count_bytes(a.data(), b.data(), n));
+        }
+    }
+}
+
+// Тест any и equal на отличии в последнем байте
+TEST(BitKernelsTest, DifferenceInTail) {
+    for (const auto *k : bit_kernels::supported()) {
+        SCOPED_TRACE(k->name);
+        for (size_t n : {1, 9, 17, 33, 65, 130}) {
+            std::vector<unsigned char> zero(n), other(n);
+            EXPECT_FALSE(k->any_bytes(zero.data(), n));
+            other.back() = 0x80;
+            EXPECT_TRUE(k->any_bytes(other.data(), n));
+            EXPECT_FALSE(k->equal_bytes(zero.data(), other.data(), n));
+        }
+    }
+}
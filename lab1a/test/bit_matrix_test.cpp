@@ -0,0 +1,139 @@
+#include "bit_matrix.h"
+#include "test_util.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+BitMatrix make_random(size_t rows, size_t cols, uint64_t seed,
+                      unsigned percent) {
+    BitMatrix m(rows, cols);
+    test_util::Random random(seed);
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < cols; c++) {
+            if (random.chance(percent)) {
+                m.set(r, c);
+            }
+        }
+    }
+    return m;
+}
+
+// Произведение, посчитанное по одному биту
+BitMatrix naive_product(const BitMatrix &a, const BitMatrix &b) {
+    BitMatrix res(a.rows(), b.cols());
+    for (size_t i = 0; i < a.rows(); i++) {
+        for (size_t j = 0; j < b.cols(); j++) {
+            for (size_t k = 0; k < a.cols(); k++) {
+                if (a(i, k) && b(k, j)) {
+                    res.set(i, j);
+                    break;
+                }
+            }
+        }
+    }
+    return res;
+}
+
+} // namespace
+
+// Тест доступа к битам, строкам и столбцам
+TEST(BitMatrixTest, RowsAndColumns) {
+    BitMatrix m(5, 70);
+    EXPECT_EQ(m.rows(), 5);
+    EXPECT_EQ(m.cols(), 70);
+    EXPECT_EQ(m.stride(), 2);
+    m.set(1, 69).set(3, 0).set(3, 69);
+    EXPECT_TRUE(m(1, 69));
+    EXPECT_FALSE(m(0, 69));
+    EXPECT_EQ(m.count(), 3);
+
+    m.row(2).set();
+    EXPECT_EQ(m.row(2).count(), 70);
+    EXPECT_EQ(m.count(), 73);
+    EXPECT_EQ(m.data()[2 * m.stride() + 1], (uint64_t{1} << 6) - 1);
+
+    ConstBitColumn col = std::as_const(m).column(69);
+    EXPECT_EQ(col.size(), 5);
+    EXPECT_EQ(col.count(), 3);
+    EXPECT_EQ(col.to_bit_array().to_string(), "01110");
+
+    m.column(0).assign(BitArray::from_string("10001"));
+    EXPECT_TRUE(m(0, 0));
+    EXPECT_FALSE(m(3, 0));
+    EXPECT_TRUE(m(4, 0));
+    m.column(0).reset(4);
+    EXPECT_FALSE(m(4, 0));
+
+    EXPECT_THROW(m.set(5, 0), std::invalid_argument);
+    EXPECT_THROW(m.set(0, 70), std::invalid_argument);
+    EXPECT_THROW(m.row(5), std::invalid_argument);
+    EXPECT_THROW(m.column(70), std::invalid_argument);
+    EXPECT_THROW(m.column(1).set(5), std::invalid_argument);
+    EXPECT_THROW(m.column(1).assign(BitArray(4)), std::invalid_argument);
+}
+
+// Тест транспонирования блоками 64x64
+TEST(BitMatrixTest, Transpose) {
+    for (auto [rows, cols] : {std::pair<size_t, size_t>{0, 0},
+                              {1, 1},
+                              {64, 64},
+                              {3, 200},
+                              {130, 65},
+                              {257, 129}}) {
+        BitMatrix m = make_random(rows, cols, rows * 1000 + cols + 1, 30);
+        BitMatrix t = m.transpose();
+        ASSERT_EQ(t.rows(), cols);
+        ASSERT_EQ(t.cols(), rows);
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < cols; c++) {
+                ASSERT_EQ(t(c, r), m(r, c)) << r << ' ' << c;
+            }
+        }
+        EXPECT_EQ(t.count(), m.count());
+        EXPECT_EQ(t.transpose(), m);
+    }
+}
+
+// Тест произведения разреженных и плотных матриц
+TEST(BitMatrixTest, Product) {
+    for (unsigned percent : {1, 10, 60}) {
+        BitMatrix a = make_random(70, 150, percent, percent);
+        BitMatrix b = make_random(150, 90, percent + 7, percent);
+        EXPECT_EQ(a * b, naive_product(a, b)) << percent;
+    }
+    BitMatrix a = make_random(20, 30, 5, 40);
+    EXPECT_EQ(BitMatrix::identity(20) * a, a);
+    EXPECT_EQ(a * BitMatrix::identity(30), a);
+    EXPECT_EQ((BitMatrix(4, 0) * BitMatrix(0, 3)), BitMatrix(4, 3));
+    EXPECT_THROW(a * a, std::invalid_argument);
+    EXPECT_THROW(a |= BitMatrix(30, 20), std::invalid_argument);
+}
+
+// Тест транзитивного замыкания возведением в квадрат
+TEST(BitMatrixTest, TransitiveClosure) {
+    const size_t n = 100;
+    BitMatrix graph = make_random(n, n, 42, 2);
+
+    BitMatrix expected = graph;
+    for (size_t k = 0; k < n; k++) {
+        for (size_t i = 0; i < n; i++) {
+            if (!expected(i, k)) {
+                continue;
+            }
+            for (size_t j = 0; j < n; j++) {
+                if (expected(k, j)) {
+                    expected.set(i, j);
+                }
+            }
+        }
+    }
+
+    BitMatrix closure = graph;
+    for (size_t len = 1; len < n; len *= 2) {
+        closure |= closure * closure;
+    }
+    EXPECT_EQ(closure, expected);
+}
@@ -0,0 +1,62 @@
+#include "bit_metrics.h"
+#include "test_util.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using test_util::make_random;
+
+// Тест метрик двух массивов на сравнении с поразрядными операциями
+TEST(BitMetricsTest, PairMetrics) {
+    for (size_t size : {0, 1, 63, 64, 65, 300, 1000}) {
+        BitArray a = make_random(size, size + 1, 40);
+        BitArray b = make_random(size, size + 2, 40);
+        size_t both = (a & b).count();
+        size_t either = (a | b).count();
+        EXPECT_EQ(hamming(a, b), (a ^ b).count());
+        EXPECT_EQ(intersect_count(a, b), both);
+        EXPECT_EQ(union_count(a, b), either);
+        EXPECT_DOUBLE_EQ(jaccard(a, b),
+                         either == 0 ? 1.0 : double(both) / either);
+        EXPECT_EQ(hamming(a, a), 0);
+        EXPECT_TRUE(is_subset(a & b, a));
+        EXPECT_TRUE(is_subset(a, a | b));
+        EXPECT_EQ(is_subset(a, b), (a & ~b).none());
+    }
+    BitArray a(10), b(11);
+    EXPECT_THROW(hamming(a, b), std::invalid_argument);
+    EXPECT_THROW(jaccard(a, b), std::invalid_argument);
+    EXPECT_THROW(is_subset(a, b), std::invalid_argument);
+}
+
+// Тест сравнения одного массива со строками матрицы
+TEST(BitMetricsTest, OneToMany) {
+    const size_t rows = 50;
+    const size_t cols = 200;
+    BitArray query = make_random(cols, 7, 30);
+    BitMatrix batch(rows, cols);
+    std::vector<BitArray> arrays;
+    for (size_t r = 0; r < rows; r++) {
+        arrays.push_back(make_random(cols, r + 100, 30));
+        batch.row(r).assign(arrays.back());
+    }
+
+    std::vector<size_t> dist(rows), common(rows), total(rows);
+    std::vector<double> sim(rows);
+    hamming_many(query, batch, dist);
+    intersect_count_many(query, batch, common);
+    union_count_many(query, batch, total);
+    jaccard_many(query, batch, sim);
+    for (size_t r = 0; r < rows; r++) {
+        EXPECT_EQ(dist[r], hamming(query, arrays[r]));
+        EXPECT_EQ(common[r], intersect_count(query, arrays[r]));
+        EXPECT_EQ(total[r], union_count(query, arrays[r]));
+        EXPECT_DOUBLE_EQ(sim[r], jaccard(query, arrays[r]));
+    }
+
+    EXPECT_THROW(hamming_many(BitArray(cols + 1), batch, dist),
+                 std::invalid_argument);
+    std::vector<size_t> short_out(rows - 1);
+    EXPECT_THROW(hamming_many(query, batch, short_out),
+                 std::invalid_argument);
+}
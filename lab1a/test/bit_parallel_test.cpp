@@ -0,0 +1,92 @@
+#include "bit_array.h"
+#include "bit_parallel.h"
+#include "test_util.h"
+#include "thread_pool.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+namespace {
+
+using test_util::make_random;
+
+// Включает параллельный режим с маленьким порогом на время теста
+class BitParallelTest : public testing::Test {
+protected:
+    void SetUp() override { bit_parallel::enable({4, 8}); }
+    void TearDown() override { bit_parallel::disable(); }
+};
+
+} // namespace
+
+// Тест выполнения всех задач пулом потоков
+TEST(ThreadPoolTest, RunsEveryTask) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+    for (size_t n : {0, 1, 3, 1000}) {
+        std::vector<std::atomic<int>> calls(n);
+        pool.run(n, [&](size_t i) { calls[i]++; });
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_EQ(calls[i], 1);
+        }
+    }
+}
+
+// Тест совпадения параллельных результатов с последовательными
+TEST_F(BitParallelTest, MatchesSequential) {
+    EXPECT_TRUE(bit_parallel::enabled());
+    for (size_t size : {5, 64, 1000, 4096 + 13, 100000}) {
+        BitArray a = make_random(size, 1);
+        BitArray b = make_random(size, 2);
+
+        bit_parallel::disable();
+        size_t expected_count = a.count();
+        BitArray expected_and = a, expected_or = a, expected_xor = a;
+        expected_and &= b;
+        expected_or |= b;
+        expected_xor ^= b;
+        bit_parallel::enable({4, 8});
+
+        EXPECT_EQ(a.count(), expected_count);
+        BitArray res = a;
+        res &= b;
+        EXPECT_EQ(res, expected_and);
+        res = a;
+        res |= b;
+        EXPECT_EQ(res, expected_or);
+        res = a;
+        res ^= b;
+        EXPECT_EQ(res, expected_xor);
+        EXPECT_EQ(res.count(), expected_xor.count());
+    }
+}
+
+// Тест поиска и сравнения с ранним выходом
+TEST_F(BitParallelTest, AnyAndEquality) {
+    BitArray bits(200000);
+    EXPECT_FALSE(bits.any());
+    EXPECT_TRUE(bits.none());
+    bits.set(199999);
+    EXPECT_TRUE(bits.any());
+
+    BitArray other(200000);
+    EXPECT_NE(bits, other);
+    other.set(199999);
+    EXPECT_EQ(bits, other);
+    other.set(3);
+    EXPECT_NE(bits, other);
+    EXPECT_NE(bits, BitArray(10));
+}
+
+// Тест операций над массивами разной длины
+TEST_F(BitParallelTest, DifferentSizes) {
+    BitArray a = make_random(50000, 3);
+    BitArray b = make_random(30001, 4);
+    BitArray expected = a;
+    for (size_t i = 0; i < b.size(); i++) {
+        expected.set(i, a[i] && b[i]);
+    }
+    a &= b;
+    EXPECT_EQ(a, expected);
+}
@@ -0,0 +1,91 @@
+#include "bit_parallel.h"
+#include "bit_reduce.h"
+#include "test_util.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+using test_util::make_random;
+
+// Порог, посчитанный по одному биту
+BitArray naive_at_least(const std::vector<const BitArray *> &arrays,
+                        size_t size, size_t k) {
+    BitArray res(size);
+    for (size_t i = 0; i < size; i++) {
+        size_t cnt = 0;
+        for (const BitArray *a : arrays) {
+            cnt += (*a)[i];
+        }
+        res.set(i, cnt >= k);
+    }
+    return res;
+}
+
+} // namespace
+
+// Тест совпадения с попарными операциями
+TEST(BitReduceTest, MatchesPairwise) {
+    for (size_t size : {0, 1, 64, 1000, 20000 + 5}) {
+        std::vector<BitArray> inputs;
+        for (size_t j = 0; j < 7; j++) {
+            inputs.push_back(make_random(size, size + j, 60 + j * 5));
+        }
+        std::vector<const BitArray *> arrays;
+        BitArray expected_and = inputs[0];
+        BitArray expected_or = inputs[0];
+        for (const BitArray &a : inputs) {
+            arrays.push_back(&a);
+            expected_and &= a;
+            expected_or |= a;
+        }
+        EXPECT_EQ(and_all(arrays), expected_and);
+        EXPECT_EQ(or_all(arrays), expected_or);
+        for (size_t k = 0; k <= arrays.size() + 1; k++) {
+            EXPECT_EQ(at_least_k(arrays, k), naive_at_least(arrays, size, k))
+                << "size " << size << " k " << k;
+        }
+    }
+}
+
+// Тест крайних случаев: пустой список, разные размеры, ранний выход
+TEST(BitReduceTest, EdgeCases) {
+    EXPECT_EQ(and_all({}).size(), 0);
+    EXPECT_EQ(or_all({}).size(), 0);
+    EXPECT_EQ(at_least_k({}, 1).size(), 0);
+
+    BitArray a(100), b(101);
+    std::vector<const BitArray *> mixed{&a, &b};
+    EXPECT_THROW(and_all(mixed), std::invalid_argument);
+    EXPECT_THROW(at_least_k(mixed, 1), std::invalid_argument);
+
+    // После пустого пересечения остальные входы не меняют результат.
+    BitArray full(5000), zero(5000);
+    full.set();
+    std::vector<const BitArray *> arrays{&full, &zero, &full};
+    EXPECT_TRUE(and_all(arrays).none());
+    EXPECT_EQ(at_least_k(arrays, 2), full);
+    EXPECT_EQ(at_least_k(arrays, 0).count(), 5000);
+}
+
+// Тест параллельного режима
+TEST(BitReduceTest, Parallel) {
+    std::vector<BitArray> inputs;
+    std::vector<const BitArray *> arrays;
+    for (size_t j = 0; j < 5; j++) {
+        inputs.push_back(make_random(100000, j, 50));
+    }
+    for (const BitArray &a : inputs) {
+        arrays.push_back(&a);
+    }
+    BitArray expected_and = and_all(arrays);
+    BitArray expected_or = or_all(arrays);
+    BitArray expected_three = at_least_k(arrays, 3);
+
+    bit_parallel::enable({4, 8});
+    EXPECT_EQ(and_all(arrays), expected_and);
+    EXPECT_EQ(or_all(arrays), expected_or);
+    EXPECT_EQ(at_least_k(arrays, 3), expected_three);
+    bit_parallel::disable();
+}
@@ -0,0 +1,111 @@
+#include "bit_span.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+
+BitArray make_pattern(size_t size, size_t step) {
+    BitArray bits(size);
+    for (size_t i = 0; i < size; i += step) {
+        bits.set(i);
+    }
+    return bits;
+}
+
+// Копия диапазона, собранная по одному биту
+BitArray slice(const BitArray &bits, size_t pos, size_t len) {
+    BitArray res(len);
+    for (size_t i = 0; i < len; i++) {
+        res.set(i, bits[pos + i]);
+    }
+    return res;
+}
+
+} // namespace
+
+// Тест чтения через представления с невыровненным началом
+TEST(BitSpanTest, ReadUnaligned) {
+    BitArray bits = make_pattern(500, 3);
+    for (size_t pos : {0, 1, 63, 64, 65, 130}) {
+        for (size_t len : {0, 1, 64, 100, 300}) {
+            ConstBitSpan span(bits, pos, len);
+            BitArray expected = slice(bits, pos, len);
+            EXPECT_EQ(span.size(), len);
+            EXPECT_EQ(span.count(), expected.count());
+            EXPECT_EQ(span.any(), expected.any());
+            EXPECT_EQ(span.to_bit_array(), expected);
+            EXPECT_EQ(span.find_first(), expected.find_first());
+            EXPECT_EQ(span.find_next(5), expected.find_next(5));
+            EXPECT_TRUE(span == expected);
+        }
+    }
+    EXPECT_THROW(ConstBitSpan(bits, 400, 101), std::invalid_argument);
+
+    ConstBitSpan raw(bits.data(), 70, 10);
+    EXPECT_EQ(raw.to_bit_array(), slice(bits, 70, 10));
+    EXPECT_EQ(raw.subspan(2, 5).to_bit_array(), slice(bits, 72, 5));
+}
+
+// Тест изменения битов через представление
+TEST(BitSpanTest, ModifyInPlace) {
+    BitArray bits(300);
+    BitSpan span(bits, 10, 200);
+    span.set();
+    EXPECT_EQ(bits.count(), 200);
+    EXPECT_FALSE(bits[9]);
+    EXPECT_TRUE(bits[10]);
+    EXPECT_TRUE(bits[209]);
+    EXPECT_FALSE(bits[210]);
+
+    span.reset(0).flip();
+    EXPECT_EQ(bits.count(), 1);
+    EXPECT_TRUE(bits[10]);
+    span.subspan(100, 50).set();
+    EXPECT_EQ(bits.count_range(110, 50), 50);
+    span.reset();
+    EXPECT_TRUE(bits.none());
+    EXPECT_THROW(span.set(200), std::invalid_argument);
+}
+
+// Тест логических операций между представлениями
+TEST(BitSpanTest, LogicBetweenSpans) {
+    BitArray a = make_pattern(400, 3);
+    BitArray b = make_pattern(400, 5);
+    for (size_t dst_pos : {0, 7, 64}) {
+        for (size_t src_pos : {0, 13, 100}) {
+            BitArray dst = a;
+            BitSpan span(dst, dst_pos, 250);
+            ConstBitSpan src(b, src_pos, 250);
+
+            BitArray expected = slice(a, dst_pos, 250);
+            expected ^= slice(b, src_pos, 250);
+            span ^= src;
+            EXPECT_EQ(span.to_bit_array(), expected);
+            EXPECT_EQ(slice(dst, 0, dst_pos), slice(a, 0, dst_pos));
+            EXPECT_EQ(slice(dst, dst_pos + 250, 400 - dst_pos - 250),
+                      slice(a, dst_pos + 250, 400 - dst_pos - 250));
+
+            expected &= slice(b, src_pos, 250);
+            span &= src;
+            EXPECT_EQ(span.to_bit_array(), expected);
+
+            span.assign(src);
+            span |= ConstBitSpan(a, 0, 250);
+            expected = slice(b, src_pos, 250) | slice(a, 0, 250);
+            EXPECT_EQ(span.to_bit_array(), expected);
+        }
+    }
+}
+
+// Тест представлений в ленивых выражениях
+TEST(BitSpanTest, Expressions) {
+    BitArray a = make_pattern(300, 2);
+    BitArray b = make_pattern(200, 7);
+    BitArray res = ConstBitSpan(a, 33, 200) & b;
+    EXPECT_EQ(res, slice(a, 33, 200) & b);
+
+    // Присваивание части массива самому массиву
+    a = ConstBitSpan(a, 1, 100);
+    EXPECT_EQ(a, slice(make_pattern(300, 2), 1, 100));
+}
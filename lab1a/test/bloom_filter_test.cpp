@@ -0,0 +1,80 @@
+#include "bloom_filter.h"
+#include "test_util.h"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint64_t> make_keys(size_t n, uint64_t seed) {
+    std::vector<uint64_t> keys(n);
+    test_util::Random random(seed);
+    for (auto &key : keys) {
+        key = random.next();
+    }
+    return keys;
+}
+
+} // namespace
+
+// Тест отсутствия ложноотрицательных ответов
+TEST(BloomFilterTest, NoFalseNegatives) {
+    BloomFilter filter(1000, 0.01);
+    EXPECT_FALSE(filter.contains(uint64_t{42}));
+    std::vector<uint64_t> keys = make_keys(1000, 1);
+    for (uint64_t key : keys) {
+        filter.insert(key);
+    }
+    for (uint64_t key : keys) {
+        EXPECT_TRUE(filter.contains(key));
+    }
+
+    filter.insert(std::string("hello"));
+    EXPECT_TRUE(filter.contains(std::string_view("hello")));
+
+    filter.clear();
+    EXPECT_FALSE(filter.contains(keys[0]));
+}
+
+// Тест доли ложноположительных ответов
+TEST(BloomFilterTest, FalsePositiveRate) {
+    for (double rate : {0.1, 0.01, 0.001}) {
+        const size_t n = 20000;
+        BloomFilter filter(n, rate);
+        EXPECT_EQ(filter.num_bits() % 512, 0);
+        filter.insert_many(make_keys(n, 2));
+
+        std::vector<uint64_t> others = make_keys(200000, 3);
+        size_t positives = 0;
+        for (uint64_t key : others) {
+            positives += filter.contains(key);
+        }
+        double measured = double(positives) / others.size();
+        EXPECT_LT(measured, rate * 1.3) << "rate " << rate;
+        EXPECT_GT(measured, rate * 0.3) << "rate " << rate;
+    }
+    EXPECT_THROW(BloomFilter(10, 0), std::invalid_argument);
+    EXPECT_THROW(BloomFilter(10, 1.5), std::invalid_argument);
+}
+
+// Тест пакетных операций
+TEST(BloomFilterTest, BatchMatchesSingle) {
+    BloomFilter single(5000, 0.02);
+    BloomFilter batched(5000, 0.02);
+    std::vector<uint64_t> keys = make_keys(5000, 4);
+    for (uint64_t key : keys) {
+        single.insert(key);
+    }
+    batched.insert_many(keys);
+
+    std::vector<uint64_t> queries = make_keys(10007, 5);
+    queries.insert(queries.end(), keys.begin(), keys.begin() + 100);
+    auto results = std::make_unique<bool[]>(queries.size());
+    batched.contains_many(queries, {results.get(), queries.size()});
+    for (size_t i = 0; i < queries.size(); i++) {
+        ASSERT_EQ(results[i], single.contains(queries[i]));
+    }
+    EXPECT_THROW(batched.contains_many(queries, {results.get(), 1}),
+                 std::invalid_argument);
+}
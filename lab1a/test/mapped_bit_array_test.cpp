@@ -0,0 +1,153 @@
+#include "mapped_bit_array.h"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+// Временный файл, удаляемый в конце теста
+class TempFile {
+public:
+    explicit TempFile(const std::string &name)
+        : path((std::filesystem::temp_directory_path() / name).string()) {}
+    ~TempFile() { std::filesystem::remove(path); }
+
+    std::string path;
+};
+
+std::string read_file(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+BitArray make_pattern(size_t size) {
+    BitArray bits(size);
+    for (size_t i = 0; i < size; i += 3) {
+        bits.set(i);
+    }
+    return bits;
+}
+
+} // namespace
+
+// Тест сохранения и чтения через отображение файла
+TEST(MappedBitArrayTest, SaveAndOpen) {
+    TempFile file("mapped_bit_array_save.bin");
+    BitArray bits = make_pattern(1000);
+    MappedBitArray::save(bits, file.path);
+
+    MappedBitArray mapped(file.path);
+    EXPECT_FALSE(mapped.writable());
+    EXPECT_EQ(mapped.size(), 1000);
+    EXPECT_EQ(mapped.count(), bits.count());
+    EXPECT_TRUE(mapped[999]);
+    EXPECT_FALSE(mapped[998]);
+    EXPECT_TRUE(mapped.verify());
+    EXPECT_EQ(mapped.to_bit_array(), bits);
+    EXPECT_THROW(mapped.set(1), std::logic_error);
+}
+
+// Тест изменения файла и повторного открытия
+TEST(MappedBitArrayTest, CreateWriteAndReopen) {
+    TempFile file("mapped_bit_array_create.bin");
+    {
+        MappedBitArray mapped = MappedBitArray::create(file.path, 200);
+        EXPECT_TRUE(mapped.none());
+        EXPECT_TRUE(mapped.verify());
+        mapped.set(0).set(64).set(199);
+        mapped.flush();
+        EXPECT_TRUE(mapped.verify());
+        mapped.set(100).reset(64);
+        // Контрольная сумма обновляется деструктором
+    }
+    MappedBitArray mapped(file.path);
+    EXPECT_TRUE(mapped.verify());
+    EXPECT_EQ(mapped.count(), 3);
+    EXPECT_TRUE(mapped[100]);
+    EXPECT_FALSE(mapped[64]);
+    EXPECT_THROW(mapped.set(200), std::invalid_argument);
+    // Чтение через data() доступно и без режима записи
+    EXPECT_EQ(mapped.data()[0] & 1, 1);
+    EXPECT_THROW(mapped.mutable_data(), std::logic_error);
+
+    // Новый файл совпадает с сохранённым нулевым массивом той же длины
+    TempFile zeros_file("mapped_bit_array_zeros.bin");
+    TempFile saved_file("mapped_bit_array_saved.bin");
+    MappedBitArray zeros = MappedBitArray::create(zeros_file.path, 1000);
+    MappedBitArray::save(BitArray(1000), saved_file.path);
+    EXPECT_EQ(read_file(zeros_file.path), read_file(saved_file.path));
+
+    TempFile empty_file("mapped_bit_array_empty.bin");
+    MappedBitArray empty = MappedBitArray::create(empty_file.path, 0);
+    EXPECT_EQ(empty.size(), 0);
+    EXPECT_TRUE(empty.none());
+}
+
+// Тест того, что чтение не перезаписывает контрольную сумму
+TEST(MappedBitArrayTest, ReadingDoesNotMarkDirty) {
+    TempFile file("mapped_bit_array_clean.bin");
+    MappedBitArray::save(make_pattern(500), file.path);
+    {
+        // Повреждение остаётся заметным, пока массив только читают
+        std::fstream f(file.path,
+                       std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(64 + 10);
+        f.put('\x5A');
+    }
+    {
+        MappedBitArray mapped(file.path, MappedBitArray::Mode::read_write);
+        EXPECT_EQ(mapped.data()[0] & 1, 1);
+        mapped.flush();
+    }
+    EXPECT_FALSE(MappedBitArray(file.path).verify());
+    {
+        MappedBitArray mapped(file.path, MappedBitArray::Mode::read_write);
+        mapped.mutable_data();
+    }
+    EXPECT_TRUE(MappedBitArray(file.path).verify());
+}
+
+// Тест выражений над отображённым массивом
+TEST(MappedBitArrayTest, Expressions) {
+    TempFile file("mapped_bit_array_expr.bin");
+    BitArray bits = make_pattern(300);
+    MappedBitArray::save(bits, file.path);
+
+    MappedBitArray mapped(file.path, MappedBitArray::Mode::read_write);
+    BitArray other(300);
+    other.set_range(0, 150);
+    BitArray res = mapped & other;
+    EXPECT_EQ(res, bits & other);
+    EXPECT_EQ((mapped ^ bits).count(), 0);
+
+    mapped = ~(mapped | other);
+    EXPECT_EQ(mapped.to_bit_array(), ~(bits | other));
+    EXPECT_THROW(mapped = BitArray(10), std::invalid_argument);
+}
+
+// Тест обнаружения повреждённых файлов
+TEST(MappedBitArrayTest, RejectsBadFiles) {
+    TempFile file("mapped_bit_array_bad.bin");
+    EXPECT_THROW(MappedBitArray(file.path), std::runtime_error);
+
+    std::ofstream(file.path, std::ios::binary) << "not a bit array";
+    EXPECT_THROW(MappedBitArray(file.path), std::runtime_error);
+
+    MappedBitArray::save(make_pattern(500), file.path);
+    std::filesystem::resize_file(file.path, 64 + 8);
+    EXPECT_THROW(MappedBitArray(file.path), std::runtime_error);
+
+    MappedBitArray::save(make_pattern(500), file.path);
+    {
+        std::fstream f(file.path,
+                       std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(64 + 10);
+        f.put('\x5A');
+    }
+    MappedBitArray mapped(file.path);
+    EXPECT_FALSE(mapped.verify());
+}
@@ -0,0 +1,61 @@
+#include "rank_select.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+BitArray make_pattern(size_t size, size_t step) {
+    BitArray bits(size);
+    for (size_t i = 0; i < size; i += step + i % 7) {
+        bits.set(i);
+    }
+    return bits;
+}
+
+} // namespace
+
+// Тест rank и select на пустом массиве
+TEST(RankSelectTest, Empty) {
+    BitArray bits;
+    RankSelect index(bits);
+    EXPECT_EQ(index.count(), 0);
+    EXPECT_EQ(index.rank(0), 0);
+    EXPECT_THROW(index.select(0), std::out_of_range);
+}
+
+// Тест rank и select против прямого перебора
+TEST(RankSelectTest, MatchesLinearScan) {
+    for (size_t size : {1, 63, 64, 65, 511, 512, 513, 5000}) {
+        for (size_t step : {1, 3, 100}) {
+            BitArray bits = make_pattern(size, step);
+            RankSelect index(bits);
+            ASSERT_EQ(index.count(), bits.count());
+
+            std::vector<size_t> positions;
+            for (size_t i = 0; i <= size; i++) {
+                ASSERT_EQ(index.rank(i), positions.size());
+                if (i < size && bits[i]) {
+                    positions.push_back(i);
+                }
+            }
+            for (size_t k = 0; k < positions.size(); k++) {
+                ASSERT_EQ(index.select(k), positions[k]);
+            }
+            EXPECT_THROW(index.select(positions.size()), std::out_of_range);
+        }
+    }
+}
+
+// Тест select для плотного массива с длинными пустыми блоками
+TEST(RankSelectTest, SparseBlocks) {
+    BitArray bits(100000);
+    bits.set(5).set(70000).set(99999);
+    RankSelect index(bits);
+    EXPECT_EQ(index.select(0), 5);
+    EXPECT_EQ(index.select(1), 70000);
+    EXPECT_EQ(index.select(2), 99999);
+    EXPECT_EQ(index.rank(70000), 1);
+    EXPECT_EQ(index.rank(100000), 3);
+    EXPECT_THROW(index.rank(100001), std::out_of_range);
+}
@@ -0,0 +1,162 @@
+#include "roaring_bitmap.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+
+// Массив с тремя видами фрагментов: разреженным, плотным и из длинных серий
+BitArray make_mixed(size_t size, size_t seed) {
+    BitArray bits(size);
+    uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+    for (size_t i = 0; i < size; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        size_t chunk = i / 65536 % 3;
+        bool dense = chunk == 1 && x % 3 != 0;
+        bool sparse = chunk == 0 && x % 1000 == 0;
+        bool run = chunk == 2 && (i + seed * 1000) / 5000 % 2 == 0;
+        if (dense || sparse || run) {
+            bits.set(i);
+        }
+    }
+    return bits;
+}
+
+} // namespace
+
+// Тест установки и сброса отдельных идентификаторов
+TEST(RoaringBitmapTest, SetResetAndTest) {
+    RoaringBitmap bitmap;
+    EXPECT_TRUE(bitmap.none());
+    bitmap.set(7).set(70000).set(4000000000u);
+    EXPECT_EQ(bitmap.count(), 3);
+    EXPECT_TRUE(bitmap[70000]);
+    EXPECT_FALSE(bitmap[70001]);
+    EXPECT_TRUE(bitmap[4000000000u]);
+
+    bitmap.reset(70000).set(7, false);
+    EXPECT_EQ(bitmap.count(), 1);
+    bitmap.reset();
+    EXPECT_TRUE(bitmap.none());
+}
+
+// Тест переходов между массивом, битовой картой и сериями
+TEST(RoaringBitmapTest, ContainerTransitions) {
+    RoaringBitmap bitmap;
+    for (uint32_t i = 0; i < 10000; i += 2) {
+        bitmap.set(i);
+    }
+    EXPECT_EQ(bitmap.count(), 5000);
+    for (uint32_t i = 0; i < 10000; i += 4) {
+        bitmap.reset(i);
+    }
+    EXPECT_EQ(bitmap.count(), 2500);
+    EXPECT_TRUE(bitmap[2]);
+    EXPECT_FALSE(bitmap[4]);
+
+    bitmap.set_range(100000, 1000000);
+    EXPECT_EQ(bitmap.count(), 1002500);
+    EXPECT_TRUE(bitmap[100000]);
+    EXPECT_TRUE(bitmap[1099999]);
+    EXPECT_FALSE(bitmap[1100000]);
+    bitmap.reset(500000);
+    EXPECT_FALSE(bitmap[500000]);
+    EXPECT_EQ(bitmap.count(), 1002499);
+}
+
+// Тест преобразования в BitArray и обратно
+TEST(RoaringBitmapTest, BitArrayRoundTrip) {
+    BitArray bits = make_mixed(300000, 1);
+    RoaringBitmap bitmap(bits);
+    EXPECT_EQ(bitmap.count(), bits.count());
+    EXPECT_EQ(bitmap.to_bit_array(bits.size()), bits);
+
+    BitArray trimmed = bitmap.to_bit_array();
+    EXPECT_EQ(trimmed.size(), bits.find_last() + 1);
+    BitArray prefix = bits;
+    prefix.resize(1000);
+    EXPECT_EQ(bitmap.to_bit_array(1000), prefix);
+}
+
+// Тест логических операций против BitArray
+TEST(RoaringBitmapTest, LogicMatchesBitArray) {
+    BitArray a = make_mixed(400000, 1);
+    BitArray b = make_mixed(400000, 2);
+    RoaringBitmap ra(a);
+    RoaringBitmap rb(b);
+
+    EXPECT_EQ((ra & rb).to_bit_array(a.size()), BitArray(a & b));
+    EXPECT_EQ((ra | rb).to_bit_array(a.size()), BitArray(a | b));
+    EXPECT_EQ((ra ^ rb).to_bit_array(a.size()), BitArray(a ^ b));
+    EXPECT_EQ((ra ^ ra).count(), 0);
+    EXPECT_EQ(ra & ra, ra);
+
+    RoaringBitmap rc = ra;
+    rc.run_optimize();
+    EXPECT_EQ(rc, ra);
+    EXPECT_NE(ra, rb);
+}
+
+// Тест экономии памяти для разреженных множеств
+TEST(RoaringBitmapTest, CompressesSparseAndRuns) {
+    RoaringBitmap sparse;
+    for (uint32_t i = 0; i < 1000; i++) {
+        sparse.set(i * 4000000u);
+    }
+    EXPECT_EQ(sparse.count(), 1000);
+    EXPECT_LT(sparse.memory_usage(), 100000);
+
+    RoaringBitmap runs;
+    runs.set_range(0, uint64_t{1} << 31);
+    EXPECT_EQ(runs.count(), size_t{1} << 31);
+    EXPECT_LT(runs.memory_usage(), runs.count() / 8 / 100);
+}
+
+// Тест изменения отдельных битов внутри серий
+TEST(RoaringBitmapTest, EditsRunsInPlace) {
+    BitArray bits(3 * 65536);
+    bits.set_range(1000, 60000);
+    bits.set_range(70000, 50000);
+    bits.set_range(140000, 300);
+    RoaringBitmap bitmap(bits);
+    uint64_t x = 12345;
+    for (int i = 0; i < 2000; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        uint32_t v = x % bits.size();
+        bool value = x >> 40 & 1;
+        bits.set(v, value);
+        bitmap.set(v, value);
+    }
+    // Сериями заканчивается и начинается каждый фрагмент
+    for (uint32_t v : {999u, 1000u, 60999u, 61000u, 65535u, 65536u}) {
+        bits.set(v, !bits[v]);
+        bitmap.set(v, bits[v]);
+    }
+    EXPECT_EQ(bitmap.to_bit_array(bits.size()), bits);
+    EXPECT_EQ(bitmap.count(), bits.count());
+    EXPECT_EQ(bitmap, RoaringBitmap(bits));
+}
+
+// Тест пересечения большого множества с маленьким
+TEST(RoaringBitmapTest, IntersectsHugeWithTiny) {
+    RoaringBitmap huge;
+    huge.set_range(0, uint64_t{1} << 32);
+    for (uint32_t v = 0; v < 1000000; v += 3) {
+        huge.reset(v);
+    }
+    RoaringBitmap tiny;
+    tiny.set(1).set(3).set(500000).set(4000000000u).set(4294967295u);
+
+    RoaringBitmap expected;
+    expected.set(1).set(500000).set(4000000000u).set(4294967295u);
+    EXPECT_EQ(huge & tiny, expected);
+    EXPECT_EQ(tiny & huge, expected);
+    RoaringBitmap in_place = tiny;
+    in_place &= huge;
+    EXPECT_EQ(in_place, expected);
+    EXPECT_TRUE((tiny & RoaringBitmap()).none());
+}
@@ -0,0 +1,73 @@
+#include "static_bit_array.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+// Маска, построенная на этапе компиляции
+constexpr StaticBitArray<256> make_mask() {
+    StaticBitArray<256> mask;
+    mask.set(0).set(255).set_range(60, 10);
+    return mask;
+}
+
+constexpr StaticBitArray<256> mask = make_mask();
+
+static_assert(mask.count() == 12);
+static_assert(mask[255] && mask[64] && !mask[70]);
+static_assert(mask.find_next(0) == 60);
+static_assert(mask.find_last() == 255);
+static_assert((mask & ~mask).none());
+static_assert((mask << 1).count() == 11);
+static_assert((mask >> 60).find_first() == 0);
+static_assert(StaticBitArray<70>().set().count() == 70);
+static_assert(StaticBitArray<8>(0xFF0F).to_string() == "00001111");
+static_assert(sizeof(StaticBitArray<256>) == 32);
+
+} // namespace
+
+// Тест основных операций
+TEST(StaticBitArrayTest, BasicOperations) {
+    StaticBitArray<100> bits(0b1011);
+    EXPECT_EQ(bits.size(), 100);
+    EXPECT_EQ(bits.num_words(), 2);
+    EXPECT_EQ(bits.count(), 3);
+    bits.reset(0).set(99);
+    EXPECT_FALSE(bits[0]);
+    EXPECT_TRUE(bits[99]);
+    EXPECT_THROW(bits.set(100), std::invalid_argument);
+    EXPECT_THROW(bits.set_range(90, 11), std::invalid_argument);
+
+    bits.flip_range(0, 100);
+    EXPECT_EQ(bits.count(), 97);
+    EXPECT_EQ(bits.count_range(0, 4), 2);
+    EXPECT_TRUE(bits.none_range(98, 0));
+    bits.reset();
+    EXPECT_TRUE(bits.none());
+    EXPECT_EQ(bits.find_first(), StaticBitArray<100>::npos);
+}
+
+// Тест совпадения результатов с BitArray
+TEST(StaticBitArrayTest, MatchesBitArray) {
+    BitArray dynamic(200);
+    for (size_t i = 0; i < 200; i += 7) {
+        dynamic.set(i);
+    }
+    StaticBitArray<200> bits(dynamic);
+    EXPECT_EQ(bits.to_bit_array(), dynamic);
+    EXPECT_EQ(bits.to_string(), dynamic.to_string());
+
+    for (size_t shift : {0, 1, 63, 64, 65, 130, 199, 200}) {
+        EXPECT_EQ((bits << shift).to_bit_array(), dynamic << shift);
+        EXPECT_EQ((bits >> shift).to_bit_array(), dynamic >> shift);
+    }
+
+    StaticBitArray<200> other;
+    other.set_range(50, 100);
+    BitArray res = dynamic ^ other;
+    EXPECT_EQ(res, (bits ^ other).to_bit_array());
+    EXPECT_EQ((~bits).to_bit_array(), BitArray(~dynamic));
+
+    // Лишние биты отбрасываются, недостающие заполняются нулями
+    EXPECT_EQ(StaticBitArray<10>(dynamic).count(), 2);
+    EXPECT_EQ(StaticBitArray<300>(dynamic).count(), dynamic.count());
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "bit_array.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace test_util {
+
+// Генератор xorshift64 для воспроизводимых случайных данных в тестах
+class Random {
+public:
+    // Зерно перемешивается, так что подходят и 0, и соседние числа
+    explicit Random(uint64_t seed) : x(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    uint64_t next() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    }
+
+    // Истина с вероятностью `percent` процентов
+    bool chance(unsigned percent) { return next() % 100 < percent; }
+
+private:
+    uint64_t x;
+};
+
+// Массив, каждый бит которого установлен с вероятностью `percent` процентов
+inline BitArray make_random(size_t size, uint64_t seed,
+                            unsigned percent = 50) {
+    BitArray bits(size);
+    Random random(seed);
+    for (size_t i = 0; i < size; i++) {
+        if (random.chance(percent)) {
+            bits.set(i);
+        }
+    }
+    return bits;
+}
+
+} // namespace test_util